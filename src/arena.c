@@ -0,0 +1,125 @@
+/****************************************************/
+/* File: arena.c                                    */
+/* Bump-pointer arena allocator for the C- compiler */
+/****************************************************/
+
+#include "globals.h"
+#include "arena.h"
+
+#define ARENA_ALIGN 8
+
+struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;        /* 데이터 크기 (헤더 제외) */
+};
+
+/* 블록 헤더 뒤의 데이터 시작 (헤더 크기도 정렬 단위에 맞춤) */
+#define BLOCK_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define blockData(b) ((char*)(b) + BLOCK_HEADER)
+
+THREAD_LOCAL Arena* curArena = NULL;
+
+void arenaInit(Arena* a, size_t blockSize)
+{
+    a->head = NULL;
+    a->cur = NULL;
+    a->ptr = NULL;
+    a->end = NULL;
+    a->blockSize = blockSize ? blockSize : ARENA_BLOCK;
+    a->used = 0;
+    a->reserved = 0;
+    a->allocs = 0;
+}
+
+/* n 바이트가 들어가는 다음 블록으로 옮긴다.
+ * 리셋 전에 쓰던 블록이 뒤에 남아 있으면 그것부터 재사용 */
+static void nextBlock(Arena* a, size_t n)
+{
+    ArenaBlock* next = a->cur ? a->cur->next : a->head;
+    ArenaBlock* b;
+
+    if (next != NULL && next->size >= n)
+        b = next;
+    else {
+        size_t size = n > a->blockSize ? n : a->blockSize;
+        b = (ArenaBlock*)malloc(BLOCK_HEADER + size);
+        if (b == NULL) {
+            fprintf(stderr, "Error: Out of memory in arena\n");
+            exit(1);
+        }
+        b->size = size;
+        /* 새 블록을 cur 뒤에 끼워 넣는다 (남은 블록은 그 뒤로) */
+        b->next = next;
+        if (a->cur) a->cur->next = b;
+        else a->head = b;
+        a->reserved += size;
+    }
+    a->cur = b;
+    a->ptr = blockData(b);
+    a->end = a->ptr + b->size;
+}
+
+void* arenaAlloc(Arena* a, size_t n)
+{
+    void* p;
+
+    n = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if ((size_t)(a->end - a->ptr) < n)
+        nextBlock(a, n);
+    p = a->ptr;
+    a->ptr += n;
+    a->used += n;
+    a->allocs++;
+    return p;
+}
+
+char* arenaStrndup(Arena* a, const char* s, size_t n)
+{
+    char* t = (char*)arenaAlloc(a, n + 1);
+    memcpy(t, s, n);
+    t[n] = '\0';
+    return t;
+}
+
+void arenaReset(Arena* a)
+{
+    a->cur = NULL;
+    a->ptr = NULL;
+    a->end = NULL;
+    a->used = 0;
+    a->allocs = 0;
+}
+
+void arenaFree(Arena* a)
+{
+    ArenaBlock* b = a->head;
+
+    while (b != NULL) {
+        ArenaBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+    arenaInit(a, a->blockSize);
+}
+
+void arenaMerge(Arena* into, Arena* from)
+{
+    ArenaBlock* tail = from->head;
+
+    if (tail == NULL) return;
+    while (tail->next != NULL)
+        tail = tail->next;
+
+    /* 쓰고 있는 블록은 목록에서 cur 앞쪽에 있어야 재사용되지 않는다:
+     * 앞에 붙이고, into 가 아직 비어 있으면 cur 를 옮겨 온 마지막 블록으로 */
+    tail->next = into->head;
+    into->head = from->head;
+    if (into->cur == NULL) {
+        into->cur = tail;
+        into->ptr = into->end = blockData(tail) + tail->size;
+    }
+    into->used += from->used;
+    into->reserved += from->reserved;
+    into->allocs += from->allocs;
+    arenaInit(from, from->blockSize);
+}
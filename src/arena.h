@@ -0,0 +1,51 @@
+/****************************************************/
+/* File: arena.h                                    */
+/* Bump-pointer arena allocator for the C- compiler */
+/****************************************************/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+#include "globals.h"
+
+/* 한 번의 컴파일 동안 쓰는 메모리(AST 노드, 문자열)를 큰 블록에서
+ * 앞으로만 잘라 준다. 개별 해제는 없고, 통째로 비우거나(arenaReset)
+ * 돌려준다(arenaFree). 할당 순서대로 메모리에 붙어 있게 된다 */
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* head;   /* 블록 목록 (리셋 후에도 유지되어 재사용) */
+    ArenaBlock* cur;    /* 지금 잘라 쓰는 블록 */
+    char* ptr;          /* cur 안의 다음 빈 자리 */
+    char* end;
+    size_t blockSize;
+    size_t used;        /* 리셋 이후 할당한 바이트 */
+    size_t reserved;    /* 블록으로 잡아 둔 전체 바이트 */
+    long allocs;        /* 리셋 이후 할당 횟수 */
+} Arena;
+
+#define ARENA_BLOCK (1 << 20)  /* 기본 블록 크기 */
+
+void arenaInit(Arena* a, size_t blockSize);
+
+/* 8 바이트 정렬된 n 바이트 (메모리가 없으면 종료) */
+void* arenaAlloc(Arena* a, size_t n);
+
+/* s[0..n) 을 '\0' 으로 끝나는 문자열로 복사 */
+char* arenaStrndup(Arena* a, const char* s, size_t n);
+
+/* 모든 할당을 O(1) 에 무효로 한다 (블록은 다음 컴파일에 재사용) */
+void arenaReset(Arena* a);
+
+/* 블록까지 모두 돌려준다 */
+void arenaFree(Arena* a);
+
+/* from 의 블록(과 그 안의 할당)을 into 로 옮긴다. from 은 빈 arena 가 된다 */
+void arenaMerge(Arena* into, Arena* from);
+
+/* 노드와 문자열을 할당할 현재 arena (main 에서 설정, 작업자 스레드는 각자) */
+extern THREAD_LOCAL Arena* curArena;
+
+#endif
@@ -0,0 +1,208 @@
+/****************************************************/
+/* File: bench.c                                    */
+/* Throughput benchmarks for the C- compiler        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+#include "source.h"
+#include "scansimd.h"
+#include "lexpar.h"
+#include "intern.h"
+#include "thread.h"
+#include "bench.h"
+
+#define BENCH_REPEAT 5   /* 측정 반복 횟수 (가장 빠른 값 사용) */
+
+typedef TokenType (*ScanFn)(ScanState*);
+
+/* fname 의 내용을 megabytes 이상이 되도록 이어 붙인 입력을 만든다 */
+static int loadBenchInput(SourceFile* sf, const char* fname, int megabytes)
+{
+    SourceFile one;
+    long want = (long)megabytes * 1024 * 1024;
+    long size;
+    char* text;
+    int unit, ok;
+
+    if (!openSource(&one, fname)) {
+        fprintf(stderr, "File %s not found\n", fname);
+        return FALSE;
+    }
+    /* 이어 붙일 때 토큰이 붙지 않도록 줄바꿈 하나를 덧붙인다 */
+    unit = one.len + 1;
+    size = (want / unit + 1) * unit;
+    if (size > 0x7ffffffe - unit) size = (0x7ffffffe / unit - 1) * (long)unit;
+    text = (char*)malloc((size_t)size);
+    if (text == NULL) {
+        closeSource(&one);
+        fprintf(stderr, "Out of memory for benchmark input\n");
+        return FALSE;
+    }
+    for (long off = 0; off < size; off += unit) {
+        memcpy(text + off, one.buf, (size_t)one.len);
+        text[off + one.len] = '\n';
+    }
+    closeSource(&one);
+
+    ok = openSourceMemory(sf, text, (int)size);
+    free(text);
+    return ok;
+}
+
+/* 파일 전체를 스캔하는 시간 (BENCH_REPEAT 회 중 최소) */
+static double timeScan(ScanFn scan, SourceFile* sf, long* ntokens)
+{
+    double best = 0.0;
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        ScanState ss;
+        long n = 0;
+        double t0 = wallClock();
+
+        scanInit(&ss, sf->buf, sf->len);
+        while (scan(&ss) != ENDFILE)
+            n++;
+
+        t0 = wallClock() - t0;
+        if (r == 0 || t0 < best) best = t0;
+        *ntokens = n;
+    }
+    return best;
+}
+
+/* 두 스캐너가 같은 토큰열을 내는지 확인 */
+static int sameTokens(ScanFn a, ScanFn b, SourceFile* sf)
+{
+    ScanState sa, sb;
+    TokenType ta, tb;
+
+    scanInit(&sa, sf->buf, sf->len);
+    scanInit(&sb, sf->buf, sf->len);
+    do {
+        ta = a(&sa);
+        tb = b(&sb);
+        if (ta != tb || sa.start != sb.start || sa.pos != sb.pos || sa.last != sb.last) {
+            fprintf(listing, "  token streams differ at offset %d\n", sa.start);
+            return FALSE;
+        }
+    } while (ta != ENDFILE);
+    return TRUE;
+}
+
+static void report(const char* name, double secs, double mb, double base)
+{
+    fprintf(listing, "  %-12s: %8.4f s  %8.1f MB/s", name, secs, mb / secs);
+    if (base > 0.0)
+        fprintf(listing, "  (%.2fx)", base / secs);
+    fprintf(listing, "\n");
+}
+
+void benchScanner(const char* fname, int megabytes)
+{
+    SourceFile sf;
+    long ntok;
+    double mb, tSwitch;
+    int best = scanSimdBest();
+    int saved;
+
+    if (!loadBenchInput(&sf, fname, megabytes)) return;
+    mb = sf.len / (1024.0 * 1024.0);
+    initScanSimd();
+    saved = scanSimdLevel();
+
+    tSwitch = timeScan(scanNextSwitch, &sf, &ntok);
+    fprintf(listing, "Scanner benchmark: %s, %.1f MB, %ld tokens (best of %d)\n",
+        fname, mb, ntok, BENCH_REPEAT);
+    report("switch DFA", tSwitch, mb, 0.0);
+
+    /* 표 기반 DFA 를 커널 수준별로 측정하고 토큰열을 switch 결과와 대조 */
+    for (int level = SIMD_SCALAR; level <= best; level++) {
+        char name[32];
+        setScanSimd(level);
+        sprintf(name, "table+%s", scanSimdName(level));
+        report(name, timeScan(scanNext, &sf, &ntok), mb, tSwitch);
+        if (!sameTokens(scanNextSwitch, scanNext, &sf))
+            fprintf(listing, "  %s: token stream MISMATCH\n", name);
+    }
+    fprintf(listing, "  token streams checked against switch DFA\n");
+
+    setScanSimd(saved);
+    closeSource(&sf);
+}
+
+/* threads 개의 스레드로 토큰 배열을 만드는 시간 (BENCH_REPEAT 회 중 최소) */
+static double timeLex(int threads, TokenArray* ta)
+{
+    double best = 0.0;
+
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+        double t0;
+        freeTokens(ta);
+        t0 = wallClock();
+        lexAllParallel(ta, threads);
+        t0 = wallClock() - t0;
+        if (r == 0 || t0 < best) best = t0;
+    }
+    return best;
+}
+
+static int sameTokenArray(const TokenArray* a, const TokenArray* b)
+{
+    if (a->count != b->count) {
+        fprintf(listing, "  token counts differ: %d vs %d\n", a->count, b->count);
+        return FALSE;
+    }
+    for (int i = 0; i < a->count; i++) {
+        const Token* x = &a->tok[i];
+        const Token* y = &b->tok[i];
+        if (x->kind != y->kind || x->line != y->line || x->start != y->start ||
+            x->len != y->len || x->val != y->val) {
+            fprintf(listing, "  tokens differ at index %d (offset %d)\n", i, x->start);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+void benchLexer(const char* fname, int megabytes)
+{
+    SourceFile saved = source;
+    TokenArray seq = { NULL, 0, 0 }, par = { NULL, 0, 0 };
+    int echo = EchoSource, trace = TraceScan;
+    int ncpu = cpuCount();
+    int maxThreads = LexThreads > 1 ? LexThreads : ncpu;  /* -lex-threads 로 지정 가능 */
+    double mb, tSeq;
+
+    if (!loadBenchInput(&source, fname, megabytes)) {
+        source = saved;
+        return;
+    }
+    mb = source.len / (1024.0 * 1024.0);
+    EchoSource = FALSE;
+    TraceScan = FALSE;
+    initIntern();
+
+    tSeq = timeLex(1, &seq);
+    fprintf(listing, "Lexer scaling: %s, %.1f MB, %d tokens, %d cores (best of %d)\n",
+        fname, mb, seq.count, ncpu, BENCH_REPEAT);
+    report("1 thread", tSeq, mb, 0.0);
+
+    /* 2, 4, 8 ... 그리고 최대 스레드 수 */
+    for (int n = 2; n <= maxThreads; n = (n * 2 > maxThreads && n < maxThreads) ? maxThreads : n * 2) {
+        char name[32];
+        sprintf(name, "%d threads", n);
+        report(name, timeLex(n, &par), mb, tSeq);
+        if (!sameTokenArray(&seq, &par))
+            fprintf(listing, "  %s: token array MISMATCH\n", name);
+    }
+    fprintf(listing, "  token arrays checked against sequential lexAll\n");
+
+    freeTokens(&seq);
+    freeTokens(&par);
+    closeSource(&source);
+    source = saved;
+    EchoSource = echo;
+    TraceScan = trace;
+}
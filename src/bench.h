@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: bench.h                                    */
+/* Throughput benchmarks for the C- compiler        */
+/****************************************************/
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+/* 스캐너 처리량: switch 기반 DFA 와 표 기반 DFA 비교.
+ * fname 의 내용을 megabytes 이상이 되도록 반복해서 입력으로 쓴다 */
+void benchScanner(const char* fname, int megabytes);
+
+/* 토큰 배열 만들기(lexAll)의 스레드 수별 확장성: 1 부터 코어 수
+ * (또는 -lex-threads 로 준 수) 까지 */
+void benchLexer(const char* fname, int megabytes);
+
+#endif
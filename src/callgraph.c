@@ -0,0 +1,276 @@
+/****************************************************/
+/* File: callgraph.c                                */
+/* Call graph and reachability for the C- compiler  */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "intern.h"
+#include "visit.h"
+#include "callgraph.h"
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in call graph\n");
+    exit(1);
+}
+
+static void* allocArray(size_t n, size_t size)
+{
+    void* p = calloc(n > 0 ? n : 1, size);
+    if (p == NULL) outOfMemory();
+    return p;
+}
+
+/* 함수 몸체에서 전역 선언을 가리키는 사용 위치를 모은다 */
+typedef struct {
+    CallNode* from;
+    int cap;
+    const int* byLoc;   /* 전역 memloc → 선언 번호 */
+    int nloc;
+    int* seen;          /* seen[j] == from 의 번호 + 1 이면 이미 넣은 간선 */
+    int stamp;
+} RefCtx;
+
+static void addRef(RefCtx* c, BucketListPtr s)
+{
+    int j;
+
+    /* 전역(범위 0)의 선언만: 지역 변수와 내장 함수(node 가 NULL)는 빼고 */
+    if (s == NULL || s->scope != 0 || s->node == NULL) return;
+    if (s->memloc < 0 || s->memloc >= c->nloc) return;
+    j = c->byLoc[s->memloc];
+    if (j < 0 || c->seen[j] == c->stamp) return;
+    c->seen[j] = c->stamp;
+
+    if (c->from->nref == c->cap) {
+        c->cap = c->cap ? c->cap * 2 : 8;
+        c->from->ref = (int*)realloc(c->from->ref, sizeof(int) * c->cap);
+        if (c->from->ref == NULL) outOfMemory();
+    }
+    c->from->ref[c->from->nref++] = j;
+}
+
+static int refPre(RefCtx* c, TreeNode* t)
+{
+    if (t->nodekind == ExpK && (t->kind.exp == IdK || t->kind.exp == CallK))
+        addRef(c, t->sym);
+    return VISIT_ALL;
+}
+
+#define REF_PRE(ctx, t, p, slot, d)  refPre(ctx, t)
+DEFINE_TREE_VISITOR(collectRefs, RefCtx, REF_PRE, VISIT_NOMID, VISIT_NOSIB, VISIT_NOPOST)
+
+/* Tarjan 의 강한 연결 요소 (명시적 스택, 재귀 없음).
+ * 요소는 끝나는 순서로 번호를 받으므로 불리는 쪽이 먼저다 */
+static void findSccs(CallGraph* g)
+{
+    int n = g->count;
+    int* index = (int*)allocArray((size_t)n, sizeof(int));
+    int* low = (int*)allocArray((size_t)n, sizeof(int));
+    int* onStack = (int*)allocArray((size_t)n, sizeof(int));
+    int* stack = (int*)allocArray((size_t)n, sizeof(int));
+    int* walkNode = (int*)allocArray((size_t)n, sizeof(int));  /* DFS 경로 */
+    int* walkEdge = (int*)allocArray((size_t)n, sizeof(int));  /* 다음에 볼 간선 */
+    int next = 1, sp = 0;
+
+    g->nscc = 0;
+    for (int root = 0; root < n; root++) {
+        int depth = 0;
+        if (index[root] != 0) continue;
+
+        walkNode[0] = root;
+        walkEdge[0] = 0;
+        index[root] = low[root] = next++;
+        stack[sp++] = root;
+        onStack[root] = TRUE;
+        depth = 1;
+
+        while (depth > 0) {
+            int v = walkNode[depth - 1];
+            CallNode* cn = &g->node[v];
+
+            if (walkEdge[depth - 1] < cn->nref) {
+                int w = cn->ref[walkEdge[depth - 1]++];
+                if (index[w] == 0) {
+                    index[w] = low[w] = next++;
+                    stack[sp++] = w;
+                    onStack[w] = TRUE;
+                    walkNode[depth] = w;
+                    walkEdge[depth] = 0;
+                    depth++;
+                }
+                else if (onStack[w] && index[w] < low[v])
+                    low[v] = index[w];
+                continue;
+            }
+
+            /* v 의 간선을 다 봤다: 요소의 뿌리면 스택에서 꺼내 번호를 준다 */
+            if (low[v] == index[v]) {
+                int w, size = 0;
+                do {
+                    w = stack[--sp];
+                    onStack[w] = FALSE;
+                    g->node[w].scc = g->nscc;
+                    size++;
+                } while (w != v);
+                if (size > 1) {
+                    for (int k = sp; k < sp + size; k++)
+                        g->node[stack[k]].recursive = TRUE;
+                }
+                g->nscc++;
+            }
+            depth--;
+            if (depth > 0) {
+                int u = walkNode[depth - 1];
+                if (low[v] < low[u]) low[u] = low[v];
+            }
+        }
+    }
+
+    /* 한 함수짜리 요소는 자기 자신을 부를 때만 재귀 */
+    for (int v = 0; v < n; v++)
+        for (int k = 0; k < g->node[v].nref; k++)
+            if (g->node[v].ref[k] == v) g->node[v].recursive = TRUE;
+
+    free(index);
+    free(low);
+    free(onStack);
+    free(stack);
+    free(walkNode);
+    free(walkEdge);
+}
+
+void buildCallGraph(TreeNode* tree, CallGraph* g)
+{
+    RefCtx c;
+    int* byLoc;
+    int nloc = 0, i;
+    TreeNode* t;
+
+    g->count = 0;
+    g->main = -1;
+    for (t = tree; t != NULL; t = t->sibling) {
+        g->count++;
+        if (t->sym != NULL && t->sym->memloc >= nloc) nloc = t->sym->memloc + 1;
+    }
+    g->node = (CallNode*)allocArray((size_t)g->count, sizeof(CallNode));
+    byLoc = (int*)allocArray((size_t)nloc, sizeof(int));
+    for (i = 0; i < nloc; i++) byLoc[i] = -1;
+
+    for (t = tree, i = 0; t != NULL; t = t->sibling, i++) {
+        g->node[i].decl = t;
+        if (t->sym != NULL) byLoc[t->sym->memloc] = i;
+        if (t->nodekind == DeclK && t->kind.decl == FunK && t->attr.atom == ATOM_MAIN)
+            g->main = i;
+    }
+
+    /* 함수마다 몸체를 한 번 훑어 간선을 모은다 */
+    c.byLoc = byLoc;
+    c.nloc = nloc;
+    c.seen = (int*)allocArray((size_t)g->count, sizeof(int));
+    for (i = 0; i < g->count; i++) {
+        t = g->node[i].decl;
+        if (t->nodekind != DeclK || t->kind.decl != FunK) continue;
+        c.from = &g->node[i];
+        c.cap = 0;
+        c.stamp = i + 1;
+        for (int k = 0; k < MAXCHILDREN; k++)
+            collectRefs(&c, t->child[k]);
+    }
+    free(c.seen);
+    free(byLoc);
+
+    findSccs(g);
+}
+
+void freeCallGraph(CallGraph* g)
+{
+    for (int i = 0; i < g->count; i++)
+        free(g->node[i].ref);
+    free(g->node);
+    g->node = NULL;
+    g->count = 0;
+}
+
+void markReachable(CallGraph* g)
+{
+    int* stack;
+    int sp = 0;
+
+    if (g->main < 0) {
+        for (int i = 0; i < g->count; i++)
+            g->node[i].reachable = TRUE;
+        return;
+    }
+
+    stack = (int*)allocArray((size_t)g->count, sizeof(int));
+    for (int i = 0; i < g->count; i++)
+        g->node[i].reachable = FALSE;
+    g->node[g->main].reachable = TRUE;
+    stack[sp++] = g->main;
+    while (sp > 0) {
+        CallNode* cn = &g->node[stack[--sp]];
+        for (int k = 0; k < cn->nref; k++) {
+            int w = cn->ref[k];
+            if (!g->node[w].reachable) {
+                g->node[w].reachable = TRUE;
+                stack[sp++] = w;
+            }
+        }
+    }
+    free(stack);
+}
+
+static int isFunction(const CallNode* cn)
+{
+    return cn->decl->nodekind == DeclK && cn->decl->kind.decl == FunK;
+}
+
+void printCallGraph(const CallGraph* g)
+{
+    fprintf(listing, "\nCall graph:\n");
+    for (int i = 0; i < g->count; i++) {
+        const CallNode* cn = &g->node[i];
+        int first = TRUE;
+
+        if (!isFunction(cn)) continue;
+        fprintf(listing, "  %s", atomName(cn->decl->attr.atom));
+        if (cn->recursive) fprintf(listing, " (recursive)");
+        for (int k = 0; k < cn->nref; k++) {
+            const CallNode* callee = &g->node[cn->ref[k]];
+            if (!isFunction(callee)) continue;
+            fprintf(listing, "%s%s", first ? " -> " : ", ", atomName(callee->decl->attr.atom));
+            first = FALSE;
+        }
+        fprintf(listing, "\n");
+    }
+}
+
+TreeNode* pruneUnreachable(CallGraph* g)
+{
+    TreeNode* head = NULL;
+    TreeNode* tail = NULL;
+    int funcs = 0, keptFuncs = 0, vars = 0, keptVars = 0;
+
+    markReachable(g);
+    for (int i = 0; i < g->count; i++) {
+        CallNode* cn = &g->node[i];
+        int fn = isFunction(cn);
+
+        if (fn) funcs++;
+        else vars++;
+        if (!cn->reachable) continue;
+        if (fn) keptFuncs++;
+        else keptVars++;
+
+        if (head == NULL) head = cn->decl;
+        else tail->sibling = cn->decl;
+        tail = cn->decl;
+    }
+    if (tail != NULL) tail->sibling = NULL;
+
+    fprintf(listing, "\nReachable from main: %d of %d functions, %d of %d global variables\n",
+            keptFuncs, funcs, keptVars, vars);
+    return head;
+}
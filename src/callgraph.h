@@ -0,0 +1,45 @@
+/****************************************************/
+/* File: callgraph.h                                */
+/* Call graph and reachability for the C- compiler  */
+/****************************************************/
+
+#ifndef _CALLGRAPH_H_
+#define _CALLGRAPH_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* 최상위 선언(전역 변수, 함수) 하나가 노드 하나.
+ * 함수 몸체가 부르는 함수와 읽고 쓰는 전역 변수로 가는 간선을 둔다.
+ * 간선은 의미 분석이 묶어 둔 sym 을 따라가므로 이름을 다시 찾지 않는다 */
+typedef struct {
+    TreeNode* decl;
+    int* ref;         /* 가리키는 선언 번호 (중복 없음, 처음 나온 순서) */
+    int nref;
+    int scc;          /* 강한 연결 요소 번호: 불리는 쪽이 먼저 (역 위상 순서) */
+    int recursive;    /* 자기 자신이나 같은 SCC 의 함수를 부른다 */
+    int reachable;    /* main 에서 닿는다 (markReachable) */
+} CallNode;
+
+typedef struct {
+    CallNode* node;   /* 선언 순서 */
+    int count;
+    int nscc;
+    int main;         /* main 함수의 번호 (없으면 -1) */
+} CallGraph;
+
+/* 분석이 끝난 (오류 없는) 선언 목록에서 */
+void buildCallGraph(TreeNode* tree, CallGraph* g);
+void freeCallGraph(CallGraph* g);
+
+/* main 에서 닿는 선언 표시 (main 이 없으면 모두) */
+void markReachable(CallGraph* g);
+
+/* 함수마다 부르는 함수와 재귀 여부 (-callgraph) */
+void printCallGraph(const CallGraph* g);
+
+/* main 에서 닿지 않는 함수와 전역 변수를 선언 목록에서 뺀다 (-reachable).
+ * 남은 목록의 머리를 돌려준다 */
+TreeNode* pruneUnreachable(CallGraph* g);
+
+#endif
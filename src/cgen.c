@@ -6,6 +6,9 @@
 #include "globals.h"
 #include "symtab.h"
 #include "cgen.h"
+#include "intern.h"
+#include "flat.h"
+#include "visit.h"
 
 /* 들여쓰기 관리 */
 static int indent = 0;
@@ -18,245 +21,231 @@ static void printIndent(void) {
     for (int i = 0; i < indent; i++) fprintf(code, "    "); /* 4 spaces */
 }
 
-/* 전방 선언 */
-static void cGen(TreeNode* tree);
-static void genDec(TreeNode* tree);
-static void genStmt(TreeNode* tree);
-static void genExp(TreeNode* tree);
-
-/* 형제 노드 리스트 순회 (주로 선언 리스트용) */
-static void genList(TreeNode* tree) {
-    TreeNode* t = tree;
-    while (t != NULL) {
-        cGen(t);
-        t = t->sibling;
+/* 이항 연산자 (앞뒤 공백 포함) */
+static const char* opString(TokenType op) {
+    switch (op) {
+    case PLUS:   return " + ";
+    case MINUS:  return " - ";
+    case TIMES:  return " * ";
+    case OVER:   return " / ";
+    case LT:     return " < ";
+    case LTE:    return " <= ";
+    case GT:     return " > ";
+    case GTE:    return " >= ";
+    case EQ:     return " == ";
+    case NEQ:    return " != ";
+    case MOD:    return " % ";
+    case SHL:    return " << ";
+    case SHR:    return " >> ";
+    case USHR:   return " >>> ";
+    default:     return "";
     }
 }
 
-/* 메인 코드 생성 디스패처 */
-static void cGen(TreeNode* tree) {
-    if (tree == NULL) return;
-    switch (tree->nodekind) {
-    case StmtK: genStmt(tree); break;
-    case ExpK:  genExp(tree);  break;
-    case DeclK: genDec(tree);  break;
-    default: break;
-    }
+/* =================================================== */
+/* 노드별 코드 생성 훅 (visit.h 의 비재귀 방문기에서 호출) */
+/* 포인터 트리와 flat 트리가 같은 훅을 쓰도록 노드를 값으로 본다 */
+/* =================================================== */
+typedef struct {
+    NodeKind nodekind;
+    int kind;          /* StmtKind / ExpKind / DeclKind */
+    int attr;          /* op / val / atom */
+    ExpType type;
+    int children;      /* 있는 자식 칸 (비트 k = child[k]) */
+} GenNode;
+
+/* 부모를 가리키는 작은 정수 (부모가 없으면 -1) */
+#define GEN_TAG(nodekind, kind) ((int)(nodekind) * 4 + (int)(kind))
+
+/* 문장 자리(if/while 의 몸체, 복합문의 문장 목록)에 있는가 */
+static int stmtSlot(int parent, int slot) {
+    return (parent == GEN_TAG(StmtK, IfK) && slot >= 1) ||
+           (parent == GEN_TAG(StmtK, WhileK) && slot == 1) ||
+           (parent == GEN_TAG(StmtK, CmpdK) && slot == 1);
 }
 
-/* 선언부 생성 (변수, 함수, 파라미터) */
-static void genDec(TreeNode* tree) {
-    switch (tree->kind.decl) {
-
-    case VarK:
+static int genPre(GenNode n, int parent, int slot) {
+    /* 문장 자리의 식은 한 줄 문장: 들여쓰기 ... ; */
+    if (n.nodekind == ExpK && stmtSlot(parent, slot))
         printIndent();
-        if (tree->type == Integer) fprintf(code, "int ");
-        else                       fprintf(code, "void ");
-        fprintf(code, "%s;\n", tree->attr.name);
-        break;
-
-    case FunK: {
-        fprintf(code, "\n");
 
-        /* main 함수 특별 처리: public static void main(String[] args) */
-        if (strcmp(tree->attr.name, "main") == 0) {
+    switch (n.nodekind) {
+    case DeclK:
+        switch ((DeclKind)n.kind) {
+        case VarK:
             printIndent();
-            fprintf(code, "public static void main(String[] args)\n");
-        }
-        else {
+            fprintf(code, n.type == Integer ? "int " : "void ");
+            fprintf(code, "%s;\n", atomName(n.attr));
+            return 0;
+        case FunK:
+            fprintf(code, "\n");
             printIndent();
-            if (tree->type == Integer) fprintf(code, "static int ");
-            else                       fprintf(code, "static void ");
-            fprintf(code, "%s(", tree->attr.name);
-
-            /* 파라미터 리스트 처리 (child[0]) */
-            TreeNode* p = tree->child[0];
-            if (p != NULL) {
-                while (p != NULL) {
-                    if (p->type == Integer) fprintf(code, "int ");
-                    else                     fprintf(code, "void ");
-                    fprintf(code, "%s", p->attr.name);
-                    if (p->sibling != NULL) fprintf(code, ", ");
-                    p = p->sibling;
-                }
+            /* main 함수 특별 처리: public static void main(String[] args) */
+            if (n.attr == ATOM_MAIN) {
+                fprintf(code, "public static void main(String[] args)\n");
+                return 1 << 1;     /* 파라미터는 건너뛰고 본문만 */
             }
-            fprintf(code, ")\n");
+            fprintf(code, n.type == Integer ? "static int " : "static void ");
+            fprintf(code, "%s(", atomName(n.attr));
+            return (1 << 0) | (1 << 1);  /* 파라미터 (child[0]), 본문 (child[1]) */
+        case ParamK:
+            fprintf(code, n.type == Integer ? "int " : "void ");
+            fprintf(code, "%s", atomName(n.attr));
+            return 0;
         }
-
-        /* 함수 본문 (child[1]) */
-        cGen(tree->child[1]);
         break;
-    }
-
-    case ParamK:
-        /* FunK에서 직접 처리하므로 여기서는 사용 안 함 */
-        break;
-    }
-}
-
-/* 문장 생성 */
-static void genStmt(TreeNode* tree) {
-    TreeNode *p1, *p2, *p3;
 
-    switch (tree->kind.stmt) {
-
-    case IfK:
+    case StmtK:
         printIndent();
-        fprintf(code, "if (");
-        p1 = tree->child[0];
-        cGen(p1);
-        fprintf(code, ")\n");
-
-        /* then-part */
-        p2 = tree->child[1];
-        if (p2->nodekind == ExpK) {
-            printIndent();
-            genExp(p2);
-            fprintf(code, ";\n");
-        } else {
-            cGen(p2);
-        }
-
-        /* else-part */
-        p3 = tree->child[2];
-        if (p3 != NULL) {
-            printIndent();
-            fprintf(code, "else\n");
-            if (p3->nodekind == ExpK) {
-                printIndent();
-                genExp(p3);
-                fprintf(code, ";\n");
-            } else {
-                cGen(p3);
-            }
+        switch ((StmtKind)n.kind) {
+        case IfK:
+            fprintf(code, "if (");
+            return n.children | (1 << 1);   /* 몸체가 비어도 ")" 는 닫는다 */
+        case WhileK:
+            fprintf(code, "while (");
+            return n.children | (1 << 1);
+        case ReturnK:
+            fprintf(code, "return");
+            if (n.children & 1) fprintf(code, " ");
+            break;
+        case CmpdK:
+            fprintf(code, "{\n");
+            indent++;
+            break;
         }
-        break;
-
-    case WhileK:
-        printIndent();
-        fprintf(code, "while (");
-        p1 = tree->child[0];
-        cGen(p1);
-        fprintf(code, ")\n");
-
-        p2 = tree->child[1];
-        if (p2->nodekind == ExpK) {
-            printIndent();
-            genExp(p2);
-            fprintf(code, ";\n");
-        } else {
-            cGen(p2);
+        return n.children;
+
+    case ExpK:
+        switch ((ExpKind)n.kind) {
+        case OpK:
+            /* 대입 연산은 괄호 없이 x = input() 형태, 나머지는 (a + b) */
+            if (n.attr != ASSIGN) fprintf(code, "(");
+            return (1 << 0) | (1 << 1);
+        case ConstK:
+            fprintf(code, "%d", n.attr);
+            return 0;
+        case IdK:
+            fprintf(code, "%s", atomName(n.attr));
+            return 0;
+        case CallK:
+            fprintf(code, "%s(", atomName(n.attr));
+            return 1 << 0;         /* 인자 목록 */
         }
         break;
+    }
+    return 0;
+}
 
-    case ReturnK:
-        printIndent();
-        fprintf(code, "return");
-        p1 = tree->child[0];
-        if (p1 != NULL) {
-            fprintf(code, " ");
-            cGen(p1);
-        }
-        fprintf(code, ";\n");
+/* 자식 칸 k 앞 */
+static void genMid(GenNode n, int k) {
+    switch (n.nodekind) {
+    case DeclK:
+        /* 파라미터 목록을 닫고 본문으로 (main 은 머리에서 끝남) */
+        if (n.kind == FunK && n.attr != ATOM_MAIN)
+            fprintf(code, ")\n");
         break;
-
-    case CmpdK:
-        printIndent();
-        fprintf(code, "{\n");
-        indent++;
-
-        /* 지역 변수 선언 (child[0]) */
-        p1 = tree->child[0];
-        genList(p1);
-
-        /* 문장 리스트 (child[1]) */
-        p2 = tree->child[1];
-        while (p2 != NULL) {
-            if (p2->nodekind == ExpK) {
+    case StmtK:
+        if (n.kind == IfK || n.kind == WhileK) {
+            if (k == 1) fprintf(code, ")\n");
+            else {
                 printIndent();
-                genExp(p2);
-                fprintf(code, ";\n");
-            } else {
-                cGen(p2);
+                fprintf(code, "else\n");
             }
-            p2 = p2->sibling;
         }
-
-        indent--;
-        printIndent();
-        fprintf(code, "}\n");
+        break;
+    case ExpK:
+        if (n.kind == OpK)
+            fprintf(code, "%s", n.attr == ASSIGN ? " = " : opString((TokenType)n.attr));
         break;
     }
 }
 
-/* 표현식 생성 */
-static void genExp(TreeNode* tree) {
-    TreeNode *p1, *p2;
-
-    switch (tree->kind.exp) {
-
-    case OpK:
-        /* 대입 연산은 괄호 없이 x = input() 형태로 출력 */
-        if (tree->attr.op == ASSIGN) {
-            p1 = tree->child[0];
-            p2 = tree->child[1];
-            cGen(p1);
-            fprintf(code, " = ");
-            cGen(p2);
-        } else {
-            /* 나머지 연산은 (a + b) 처럼 괄호로 감싸기 */
-            fprintf(code, "(");
-            p1 = tree->child[0];
-            cGen(p1);
-
-            switch (tree->attr.op) {
-            case PLUS:   fprintf(code, " + ");  break;
-            case MINUS:  fprintf(code, " - ");  break;
-            case TIMES:  fprintf(code, " * ");  break;
-            case OVER:   fprintf(code, " / ");  break;
-            case LT:     fprintf(code, " < ");  break;
-            case LTE:    fprintf(code, " <= "); break;
-            case GT:     fprintf(code, " > ");  break;
-            case GTE:    fprintf(code, " >= "); break;
-            case EQ:     fprintf(code, " == "); break;
-            case NEQ:    fprintf(code, " != "); break;
-            default: break;
-            }
+/* 같은 목록의 다음 형제 앞: 인자와 파라미터는 쉼표로 */
+static void genSib(int parent) {
+    if (parent == GEN_TAG(ExpK, CallK) || parent == GEN_TAG(DeclK, FunK))
+        fprintf(code, ", ");
+}
 
-            p2 = tree->child[1];
-            cGen(p2);
-            fprintf(code, ")");
+static void genPost(GenNode n, int parent, int slot) {
+    if (n.nodekind == StmtK) {
+        if (n.kind == ReturnK)
+            fprintf(code, ";\n");
+        else if (n.kind == CmpdK) {
+            indent--;
+            printIndent();
+            fprintf(code, "}\n");
         }
-        break;
+    }
+    else if (n.nodekind == ExpK) {
+        if ((n.kind == OpK && n.attr != ASSIGN) || n.kind == CallK)
+            fprintf(code, ")");
+        if (stmtSlot(parent, slot))
+            fprintf(code, ";\n");
+    }
+}
 
-    case ConstK:
-        fprintf(code, "%d", tree->attr.val);
-        break;
+/* 포인터 트리 */
+static GenNode treeNode(TreeNode* t) {
+    GenNode n;
+    n.nodekind = t->nodekind;
+    switch (t->nodekind) {
+    case StmtK: n.kind = (int)t->kind.stmt; break;
+    case ExpK:  n.kind = (int)t->kind.exp;  break;
+    default:    n.kind = (int)t->kind.decl; break;
+    }
+    n.attr = t->attr.val;
+    n.type = t->type;
+    n.children = 0;
+    for (int k = 0; k < MAXCHILDREN; k++)
+        if (t->child[k] != NULL) n.children |= 1 << k;
+    return n;
+}
 
-    case IdK:
-        fprintf(code, "%s", tree->attr.name);
-        break;
+static int treeTag(TreeNode* t) {
+    GenNode n;
+    if (t == NULL) return -1;
+    n = treeNode(t);
+    return GEN_TAG(n.nodekind, n.kind);
+}
 
-    case CallK:
-        fprintf(code, "%s(", tree->attr.name);
-        p1 = tree->child[0];
-        while (p1 != NULL) {
-            cGen(p1);
-            if (p1->sibling != NULL) fprintf(code, ", ");
-            p1 = p1->sibling;
-        }
-        fprintf(code, ")");
-        break;
-    }
+#define GEN_TREE_PRE(ctx, t, p, slot, d) genPre(treeNode(t), treeTag(p), slot)
+#define GEN_TREE_MID(ctx, t, k)          genMid(treeNode(t), k)
+#define GEN_TREE_SIB(ctx, t, p, slot)    genSib(treeTag(p))
+#define GEN_TREE_POST(ctx, t, p, slot)   genPost(treeNode(t), treeTag(p), slot)
+DEFINE_TREE_VISITOR(genTree, void, GEN_TREE_PRE, GEN_TREE_MID, GEN_TREE_SIB, GEN_TREE_POST)
+
+/* flat 트리 */
+typedef struct { const FlatTree* flat; } GenFlat;
+
+static GenNode flatNode(const FlatTree* f, int i) {
+    GenNode n;
+    n.nodekind = flatNodeKind(f, i);
+    n.kind = flatKind(f, i);
+    n.attr = f->attr[i];
+    n.type = flatType(f, i);
+    n.children = (int)FL_CHILDMASK(f->info[i]);
+    return n;
 }
 
-/* 코드 생성 메인 함수: Java 코드 생성 */
-void codeGen(TreeNode* syntaxTree, char* codefile) {
+static int flatTag(const FlatTree* f, int i) {
+    return i < 0 ? -1 : GEN_TAG(flatNodeKind(f, i), flatKind(f, i));
+}
+
+#define GEN_FLAT_PRE(ctx, i, p, slot, d) genPre(flatNode((ctx)->flat, i), flatTag((ctx)->flat, p), slot)
+#define GEN_FLAT_MID(ctx, i, k)          genMid(flatNode((ctx)->flat, i), k)
+#define GEN_FLAT_SIB(ctx, i, p, slot)    genSib(flatTag((ctx)->flat, p))
+#define GEN_FLAT_POST(ctx, i, p, slot)   genPost(flatNode((ctx)->flat, i), flatTag((ctx)->flat, p), slot)
+DEFINE_FLAT_VISITOR(genFlat, GenFlat, GEN_FLAT_PRE, GEN_FLAT_MID, GEN_FLAT_SIB, GEN_FLAT_POST)
+
+/* 출력 파일(path)을 열고 클래스 머리와 런타임 함수를 쓴다.
+ * 클래스 이름은 codefile 에서 만든다.
+ * 돌려준 파일 이름은 closeCode 에서 해제 (실패하면 NULL) */
+static char* openCode(char* codefile, const char* path) {
     /* codefile: main에서 넘긴 출력 파일 이름 (예: test1_out.java) */
     char* s = (char*)malloc(strlen(codefile) + 1);
     if (s == NULL) {
         fprintf(listing, "Out of memory for code file name\n");
-        return;
+        return NULL;
     }
     strcpy(s, codefile);
 
@@ -273,11 +262,11 @@ void codeGen(TreeNode* syntaxTree, char* codefile) {
     memcpy(className, s, len);
     className[len] = '\0';
 
-    code = fopen(s, "w");
+    code = fopen(path, "w");
     if (code == NULL) {
-        fprintf(listing, "Unable to open %s for writing\n", s);
+        fprintf(listing, "Unable to open %s for writing\n", path);
         free(s);
-        return;
+        return NULL;
     }
 
     /* 1. Java preamble + 클래스 선언 */
@@ -312,10 +301,12 @@ void codeGen(TreeNode* syntaxTree, char* codefile) {
     printIndent();
     fprintf(code, "}\n");
 
-    /* 3. AST 순회하며 코드 생성 (프로그램 = declaration list) */
     fprintf(code, "\n    /* Generated code */\n");
-    genList(syntaxTree);
+    return s;
+}
 
+/* 클래스를 닫고 파일을 마무리 */
+static void closeCode(char* s) {
     /* 4. 클래스 닫기 */
     indent = 0;
     fprintf(code, "}\n");
@@ -324,3 +315,400 @@ void codeGen(TreeNode* syntaxTree, char* codefile) {
     fprintf(listing, "Code generation finished. Output: %s\n", s);
     free(s);
 }
+
+/* 코드 생성 메인 함수: Java 코드 생성 */
+void codeGen(TreeNode* syntaxTree, char* codefile) {
+    char* s = openCode(codefile, codefile);
+    if (s == NULL) return;
+
+    /* 3. AST 순회하며 코드 생성 (프로그램 = declaration list) */
+    genTree(NULL, syntaxTree);
+    closeCode(s);
+}
+
+/* 같은 코드를 flat 트리에서 생성 */
+void codeGenFlat(const FlatTree* f, char* codefile) {
+    GenFlat ctx;
+    char* s = openCode(codefile, codefile);
+    if (s == NULL) return;
+
+    ctx.flat = f;
+    genFlat(&ctx, f->count > 0 ? 0 : -1);
+    closeCode(s);
+}
+
+/* =================================================== */
+/* SSA IR 에서 생성                                     */
+/* =================================================== */
+typedef struct {
+    const IrFunc* f;
+    int* uses;             /* 값을 읽는 곳의 수 */
+    char* isParam;         /* Java 파라미터 그 자체인 값 */
+    char* inlined;         /* 조건식으로 바로 쓰는 비교 */
+    char* isConst;         /* CONST 로 정의된 값: 쓰는 곳에 수를 그대로 */
+    int* constVal;
+    int loopHeader;        /* 꼬리 재귀를 없앤 함수의 LOOP 머리 (없으면 -1) */
+} IrGen;
+
+static void putConst(int imm);
+
+/* 값의 Java 이름: 파라미터는 원래 이름, 변수에서 온 값은 이름_번호, 나머지는 _t번호.
+ * C- 식별자에는 '_' 가 없으므로 사용자 이름과 겹치지 않는다 */
+static void putValue(const IrGen* g, int v) {
+    int var = g->f->valueVar[v];
+    if (g->isConst[v]) putConst(g->constVal[v]);
+    else if (g->isParam[v]) fprintf(code, "%s", atomName(g->f->var[var].atom));
+    else if (var >= 0) fprintf(code, "%s_%d", atomName(g->f->var[var].atom), v);
+    else fprintf(code, "_t%d", v);
+}
+
+static void putConst(int imm) {
+    /* -2147483648 은 Java 의 int 리터럴이 아니다 */
+    if (imm == (int)0x80000000) fprintf(code, "(-2147483647 - 1)");
+    else fprintf(code, "%d", imm);
+}
+
+static int isCompare(int op) {
+    return op >= LT && op <= NEQ;
+}
+
+/* 조건: 같은 블록에서 한 번만 쓰는 비교면 바로 "a < b", 아니면 "v != 0" */
+static void putCond(const IrGen* g, int block, int v) {
+    const IrBlock* b = &g->f->block[block];
+    for (int k = 0; k < b->ninst; k++) {
+        const IrInst* in = &b->inst[k];
+        if (in->dst == v && in->op == IR_BIN && isCompare(in->imm) && g->inlined[v]) {
+            putValue(g, in->a);
+            fprintf(code, "%s", opString((TokenType)in->imm));
+            putValue(g, in->b);
+            return;
+        }
+    }
+    putValue(g, v);
+    fprintf(code, " != 0");
+}
+
+/* 따로 쓰지 않는 값: 상수, 조건식에 들어간 비교, 아무도 읽지 않는 복사 / 전역 읽기 */
+static int omitted(const IrGen* g, const IrInst* in) {
+    if (in->dst < 0) return FALSE;
+    if (g->inlined[in->dst] || g->isConst[in->dst]) return TRUE;
+    return g->uses[in->dst] == 0 &&
+           (in->op == IR_CONST || in->op == IR_COPY || in->op == IR_LOADG);
+}
+
+static void genInst(const IrGen* g, const IrInst* in) {
+    if (in->op == IR_PHI || in->op == IR_PARAM || in->op == IR_NOP) return;
+    if (omitted(g, in)) return;
+
+    printIndent();
+    if (in->dst >= 0) {
+        putValue(g, in->dst);
+        fprintf(code, " = ");
+    }
+    switch (in->op) {
+    case IR_CONST:
+        putConst(in->imm);
+        break;
+    case IR_COPY:
+        putValue(g, in->a);
+        break;
+    case IR_BIN:
+        putValue(g, in->a);
+        fprintf(code, "%s", opString((TokenType)in->imm));
+        putValue(g, in->b);
+        if (isCompare(in->imm)) fprintf(code, " ? 1 : 0");
+        break;
+    case IR_LOADG:
+        fprintf(code, "%s", atomName(in->sym->atom));
+        break;
+    case IR_STOREG:
+        fprintf(code, "%s = ", atomName(in->sym->atom));
+        putValue(g, in->a);
+        break;
+    case IR_CALL:
+        fprintf(code, "%s(", atomName(in->sym->atom));
+        for (int k = 0; k < in->nargs; k++) {
+            if (k > 0) fprintf(code, ", ");
+            putValue(g, in->args[k]);
+        }
+        fprintf(code, ")");
+        break;
+    default:
+        break;
+    }
+    fprintf(code, ";\n");
+}
+
+/* block 에서 succ 로 갈 때 succ 의 PHI 들을 한꺼번에 복사한다.
+ * 한 복사의 대상이 다른 복사의 원본이면 임시 변수를 거친다 */
+static void genPhiCopies(const IrGen* g, int block, int succ) {
+    const IrBlock* s = &g->f->block[succ];
+    int j = irPredIndex(s, block);
+    int n = 0, clash = FALSE;
+
+    while (n < s->ninst && s->inst[n].op == IR_PHI) n++;
+    for (int k = 0; k < n; k++)
+        for (int m = 0; m < n; m++)
+            if (m != k && s->inst[m].args[j] == s->inst[k].dst) clash = TRUE;
+
+    if (!clash) {
+        for (int k = 0; k < n; k++) {
+            if (s->inst[k].args[j] == s->inst[k].dst) continue;
+            printIndent();
+            putValue(g, s->inst[k].dst);
+            fprintf(code, " = ");
+            putValue(g, s->inst[k].args[j]);
+            fprintf(code, ";\n");
+        }
+        return;
+    }
+    printIndent();
+    fprintf(code, "{\n");
+    indent++;
+    for (int k = 0; k < n; k++) {
+        printIndent();
+        fprintf(code, "int _c%d = ", k);
+        putValue(g, s->inst[k].args[j]);
+        fprintf(code, ";\n");
+    }
+    for (int k = 0; k < n; k++) {
+        printIndent();
+        putValue(g, s->inst[k].dst);
+        fprintf(code, " = _c%d;\n", k);
+    }
+    indent--;
+    printIndent();
+    fprintf(code, "}\n");
+}
+
+/* 블록의 명령과 끝 (BR 은 구조 트리가 if / while 로 쓴다) */
+static void genBlock(const IrGen* g, int block) {
+    const IrBlock* b = &g->f->block[block];
+
+    for (int k = 0; k < b->ninst; k++)
+        genInst(g, &b->inst[k]);
+    if (b->term == TERM_JMP) {
+        genPhiCopies(g, block, b->succ[0]);
+        /* 진입 블록이 아닌 곳에서 LOOP 머리로: 안쪽 while 을 건너 바깥 고리로 */
+        if (b->succ[0] == g->loopHeader && block != 0) {
+            printIndent();
+            fprintf(code, "continue _tail;\n");
+        }
+    }
+    else if (b->term == TERM_RET) {
+        printIndent();
+        if (b->value >= 0) {
+            fprintf(code, "return ");
+            putValue(g, b->value);
+            fprintf(code, ";\n");
+        }
+        else
+            fprintf(code, "return;\n");
+    }
+}
+
+/* 빈 else: 명령이 없고 합류 지점에 PHI 도 없는 블록 하나 */
+static int emptyBranch(const IrGen* g, const IrRegion* seq) {
+    const IrBlock* b;
+    const IrBlock* join;
+
+    if (seq == NULL || seq->body == NULL) return TRUE;
+    if (seq->body->next != NULL || seq->body->kind != IRS_BLOCK) return FALSE;
+    b = &g->f->block[seq->body->block];
+    if (b->ninst > 0 || b->term != TERM_JMP) return FALSE;
+    join = &g->f->block[b->succ[0]];
+    return join->ninst == 0 || join->inst[0].op != IR_PHI;
+}
+
+/* 구조 트리는 문장의 중첩만큼 깊다 (파서도 문장은 재귀로 읽는다) */
+static void genRegion(const IrGen* g, const IrRegion* r) {
+    for (; r != NULL; r = r->next) {
+        switch (r->kind) {
+        case IRS_SEQ:
+            genRegion(g, r->body);
+            break;
+        case IRS_BLOCK:
+            genBlock(g, r->block);
+            break;
+        case IRS_IF:
+            printIndent();
+            fprintf(code, "if (");
+            putCond(g, r->block, g->f->block[r->block].value);
+            fprintf(code, ")\n");
+            printIndent();
+            fprintf(code, "{\n");
+            indent++;
+            genRegion(g, r->body);
+            indent--;
+            printIndent();
+            fprintf(code, "}\n");
+            if (!emptyBranch(g, r->alt)) {
+                printIndent();
+                fprintf(code, "else\n");
+                printIndent();
+                fprintf(code, "{\n");
+                indent++;
+                genRegion(g, r->alt);
+                indent--;
+                printIndent();
+                fprintf(code, "}\n");
+            }
+            break;
+        case IRS_WHILE:
+            printIndent();
+            fprintf(code, "while (true)\n");
+            printIndent();
+            fprintf(code, "{\n");
+            indent++;
+            genBlock(g, r->block);
+            printIndent();
+            fprintf(code, "if (!(");
+            putCond(g, r->block, g->f->block[r->block].value);
+            fprintf(code, ")) break;\n");
+            genRegion(g, r->body);
+            indent--;
+            printIndent();
+            fprintf(code, "}\n");
+            break;
+        case IRS_LOOP:
+            printIndent();
+            fprintf(code, "_tail:\n");
+            printIndent();
+            fprintf(code, "while (true)\n");
+            printIndent();
+            fprintf(code, "{\n");
+            indent++;
+            genRegion(g, r->body);
+            indent--;
+            printIndent();
+            fprintf(code, "}\n");
+            break;
+        }
+    }
+}
+
+static void countUse(IrGen* g, int v) {
+    if (v >= 0) g->uses[v]++;
+}
+
+static void genIrFunc(const IrFunc* f) {
+    IrGen g;
+    TreeNode* fun = f->decl;
+    int n = f->nvalues > 0 ? f->nvalues : 1;
+
+    g.f = f;
+    g.uses = (int*)calloc((size_t)n, sizeof(int));
+    g.isParam = (char*)calloc((size_t)n, 1);
+    g.inlined = (char*)calloc((size_t)n, 1);
+    g.isConst = (char*)calloc((size_t)n, 1);
+    g.constVal = (int*)calloc((size_t)n, sizeof(int));
+    g.loopHeader = -1;
+    if (g.uses == NULL || g.isParam == NULL || g.inlined == NULL || g.isConst == NULL || g.constVal == NULL) {
+        fprintf(stderr, "Error: Out of memory in code generation\n");
+        exit(1);
+    }
+
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            const IrInst* in = &b->inst[k];
+            if (in->op == IR_PARAM) g.isParam[in->dst] = TRUE;
+            if (in->op == IR_CONST) {
+                g.isConst[in->dst] = TRUE;
+                g.constVal[in->dst] = in->imm;
+            }
+            countUse(&g, in->a);
+            countUse(&g, in->b);
+            if (in->op == IR_CALL || in->op == IR_PHI)
+                for (int j = 0; j < in->nargs; j++) countUse(&g, in->args[j]);
+        }
+        if (b->term == TERM_BR || b->term == TERM_RET) countUse(&g, b->value);
+    }
+    for (const IrRegion* r = f->region->body; r != NULL; r = r->next)
+        if (r->kind == IRS_LOOP) g.loopHeader = r->block;
+    /* 분기에서만 한 번 쓰는 비교는 조건식으로 바로 */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        if (b->term != TERM_BR || g.uses[b->value] != 1) continue;
+        for (int k = 0; k < b->ninst; k++)
+            if (b->inst[k].dst == b->value && b->inst[k].op == IR_BIN && isCompare(b->inst[k].imm))
+                g.inlined[b->value] = TRUE;
+    }
+
+    /* 머리: AST 경로와 같은 모양 */
+    fprintf(code, "\n");
+    printIndent();
+    if (fun->attr.atom == ATOM_MAIN)
+        fprintf(code, "public static void main(String[] args)\n");
+    else {
+        fprintf(code, fun->type == Integer ? "static int " : "static void ");
+        fprintf(code, "%s(", atomName(fun->attr.atom));
+        for (TreeNode* p = fun->child[0]; p != NULL; p = p->sibling) {
+            fprintf(code, "int %s", atomName(p->attr.atom));
+            if (p->sibling != NULL) fprintf(code, ", ");
+        }
+        fprintf(code, ")\n");
+    }
+    printIndent();
+    fprintf(code, "{\n");
+    indent++;
+
+    /* 값은 모두 함수 머리에서 선언 (구조 블록 밖에서도 쓰일 수 있다) */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            int v = b->inst[k].dst;
+            if (v < 0 || g.isParam[v] || omitted(&g, &b->inst[k])) continue;
+            printIndent();
+            fprintf(code, "int ");
+            putValue(&g, v);
+            fprintf(code, " = 0;\n");
+        }
+    }
+
+    genRegion(&g, f->region);
+
+    indent--;
+    printIndent();
+    fprintf(code, "}\n");
+    free(g.uses);
+    free(g.isParam);
+    free(g.inlined);
+    free(g.isConst);
+    free(g.constVal);
+}
+
+void codeGenIr(const IrProgram* prog, char* codefile) {
+    char* s = openCode(codefile, codefile);
+    int fn = 0;
+    if (s == NULL) return;
+
+    /* 선언 순서대로: 전역 변수는 static 필드 (static 함수에서 쓰므로) */
+    for (TreeNode* t = prog->decls; t != NULL; t = t->sibling) {
+        if (t->nodekind != DeclK) continue;
+        if (t->kind.decl == VarK) {
+            printIndent();
+            fprintf(code, "static int %s;\n", atomName(t->attr.atom));
+        }
+        else if (t->kind.decl == FunK && fn < prog->nfuncs)
+            genIrFunc(&prog->func[fn++]);
+    }
+    closeCode(s);
+}
+
+/* 파이프라인: 선언 하나씩 생성 (codeGenBegin 의 s 는 codeGenEnd 가 해제) */
+static char* streamName = NULL;
+
+int codeGenBegin(char* codefile, const char* path) {
+    streamName = openCode(codefile, path);
+    return streamName != NULL;
+}
+
+void codeGenDecl(TreeNode* decl) {
+    genTree(NULL, decl);
+}
+
+void codeGenEnd(void) {
+    closeCode(streamName);
+    streamName = NULL;
+}
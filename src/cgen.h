@@ -7,8 +7,23 @@
 #define _CGEN_H_
 
 #include "globals.h"
+#include "flat.h"
+#include "ir.h"
 
 /* codeGen takes a syntax tree and generates code into a file */
 void codeGen(TreeNode* syntaxTree, char* codefile);
 
+/* 같은 코드를 flat 트리(flat.h)에서 생성 */
+void codeGenFlat(const FlatTree* f, char* codefile);
+
+/* SSA IR(ir.h)에서 생성 (-ir). 구조 트리를 따라 if / while 로 되돌리고,
+ * PHI 는 선행 블록 끝의 복사로 푼다 */
+void codeGenIr(const IrProgram* prog, char* codefile);
+
+/* 파이프라인 모드: 최상위 선언을 하나씩 (decl->sibling 은 NULL).
+ * 파일은 path 에 쓰고 클래스 이름은 codefile 에서 만든다 */
+int codeGenBegin(char* codefile, const char* path);
+void codeGenDecl(TreeNode* decl);
+void codeGenEnd(void);
+
 #endif
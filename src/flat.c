@@ -0,0 +1,126 @@
+/****************************************************/
+/* File: flat.c                                     */
+/* Compact index-based AST for the C- compiler      */
+/****************************************************/
+
+#include "globals.h"
+#include "flat.h"
+#include "visit.h"
+
+static void growFlat(FlatTree* f)
+{
+    int cap = f->cap ? f->cap * 2 : 4096;
+
+    f->info = (unsigned short*)realloc(f->info, sizeof(unsigned short) * cap);
+    f->attr = (int*)realloc(f->attr, sizeof(int) * cap);
+    f->lineno = (int*)realloc(f->lineno, sizeof(int) * cap);
+    f->end = (int*)realloc(f->end, sizeof(int) * cap);
+    if (f->info == NULL || f->attr == NULL || f->lineno == NULL || f->end == NULL) {
+        fprintf(stderr, "Error: Out of memory for flat tree\n");
+        exit(1);
+    }
+    f->cap = cap;
+}
+
+static int kindOf(TreeNode* t)
+{
+    switch (t->nodekind) {
+    case StmtK: return (int)t->kind.stmt;
+    case ExpK:  return (int)t->kind.exp;
+    default:    return (int)t->kind.decl;
+    }
+}
+
+/* 펼치는 중인 상태: 서브트리가 아직 안 끝난 노드의 인덱스 스택 */
+typedef struct {
+    FlatTree* f;
+    int* open;
+    int nopen;
+    int openCap;
+} Flattener;
+
+/* 전위 순서로 자리를 잡고, 서브트리가 끝나면(POST) end 를 채운다 */
+static int flattenPre(Flattener* fl, TreeNode* t)
+{
+    FlatTree* f = fl->f;
+    int i = f->count++;
+    unsigned int info;
+
+    if (i == f->cap) growFlat(f);
+    info = (unsigned int)t->nodekind | ((unsigned int)kindOf(t) << 2) |
+           ((unsigned int)t->type << 4);
+    for (int k = 0; k < MAXCHILDREN; k++)
+        if (t->child[k] != NULL) info |= 1u << (5 + k);
+    if (t->sibling != NULL) info |= FL_SIBLING;
+    f->info[i] = (unsigned short)info;
+    f->attr[i] = t->attr.val;
+    f->lineno[i] = t->lineno;
+
+    if (fl->nopen == fl->openCap) {
+        fl->openCap = fl->openCap ? fl->openCap * 2 : 256;
+        fl->open = (int*)realloc(fl->open, sizeof(int) * fl->openCap);
+        if (fl->open == NULL) {
+            fprintf(stderr, "Error: Out of memory for flat tree\n");
+            exit(1);
+        }
+    }
+    fl->open[fl->nopen++] = i;
+    return VISIT_ALL;
+}
+
+static void flattenPost(Flattener* fl)
+{
+    fl->f->end[fl->open[--fl->nopen]] = fl->f->count;
+}
+
+#define FLATTEN_PRE(ctx, t, p, slot, d)  flattenPre(ctx, t)
+#define FLATTEN_POST(ctx, t, p, slot)    flattenPost(ctx)
+DEFINE_TREE_VISITOR(flattenVisit, Flattener, FLATTEN_PRE, VISIT_NOMID, VISIT_NOSIB, FLATTEN_POST)
+
+void flattenTree(TreeNode* tree, FlatTree* f)
+{
+    Flattener fl;
+
+    f->info = NULL;
+    f->attr = NULL;
+    f->lineno = NULL;
+    f->end = NULL;
+    f->count = 0;
+    f->cap = 0;
+    fl.f = f;
+    fl.open = NULL;
+    fl.nopen = 0;
+    fl.openCap = 0;
+    flattenVisit(&fl, tree);
+    free(fl.open);
+}
+
+void freeFlatTree(FlatTree* f)
+{
+    free(f->info);
+    free(f->attr);
+    free(f->lineno);
+    free(f->end);
+    f->info = NULL;
+    f->attr = NULL;
+    f->lineno = NULL;
+    f->end = NULL;
+    f->count = 0;
+    f->cap = 0;
+}
+
+int flatChild(const FlatTree* f, int i, int k)
+{
+    unsigned int mask = FL_CHILDMASK(f->info[i]);
+    int c = i + 1;
+
+    if (!(mask & (1u << k))) return -1;
+    /* 앞쪽 자식 목록들을 건너뛴다 (형제 사슬을 따라 end 로) */
+    for (int s = 0; s < k; s++) {
+        if (!(mask & (1u << s))) continue;
+        while (flatHasSibling(f, c))
+            c = f->end[c];
+        c = f->end[c];
+    }
+    return c;
+}
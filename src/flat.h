@@ -0,0 +1,48 @@
+/****************************************************/
+/* File: flat.h                                     */
+/* Compact index-based AST for the C- compiler      */
+/****************************************************/
+
+#ifndef _FLAT_H_
+#define _FLAT_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* TreeNode 트리를 전위 순서로 펼친 배열(struct-of-arrays) 표현.
+ * 노드 i 의 자식 목록들은 i+1 부터 child[0], child[1], child[2] 순서로
+ * 이어지고, 형제는 자기 서브트리가 끝나는 end[i] 에 놓인다.
+ * 노드 하나가 14 바이트 (TreeNode 는 64 바이트) */
+
+/* info 비트 구성 */
+#define FL_NODEKIND(x)  ((x) & 0x3)          /* NodeKind */
+#define FL_KIND(x)      (((x) >> 2) & 0x3)   /* StmtKind / ExpKind / DeclKind */
+#define FL_TYPE(x)      (((x) >> 4) & 0x1)   /* ExpType */
+#define FL_CHILDMASK(x) (((x) >> 5) & 0x7)   /* 있는 자식 칸 (비트 k = child[k]) */
+#define FL_SIBLING      0x100                /* 형제가 end[i] 에 있다 */
+
+typedef struct {
+    unsigned short* info;
+    int* attr;        /* op / val / atom */
+    int* lineno;
+    int* end;         /* 자기 서브트리 다음 인덱스 (형제 제외) */
+    int count;
+    int cap;
+} FlatTree;
+
+#define flatNodeKind(f, i) ((NodeKind)FL_NODEKIND((f)->info[i]))
+#define flatKind(f, i)     ((int)FL_KIND((f)->info[i]))
+#define flatType(f, i)     ((ExpType)FL_TYPE((f)->info[i]))
+#define flatHasSibling(f, i) (((f)->info[i] & FL_SIBLING) != 0)
+
+/* 다음 형제 (없으면 -1) */
+#define flatSibling(f, i)  (flatHasSibling(f, i) ? (f)->end[i] : -1)
+
+/* 트리 전체(최상위 형제 목록 포함)를 펼친다. 빈 트리면 count 0 */
+void flattenTree(TreeNode* tree, FlatTree* f);
+void freeFlatTree(FlatTree* f);
+
+/* 노드 i 의 k 번째 자식 목록의 첫 노드 (없으면 -1) */
+int flatChild(const FlatTree* f, int i, int k);
+
+#endif
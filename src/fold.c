@@ -0,0 +1,637 @@
+/****************************************************/
+/* File: fold.c                                     */
+/* Constant folding and propagation for C-          */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "symtab.h"
+#include "visit.h"
+#include "fold.h"
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in optimizer\n");
+    exit(1);
+}
+
+static void* allocArray(size_t n, size_t size)
+{
+    void* p = calloc(n > 0 ? n : 1, size);
+    if (p == NULL) outOfMemory();
+    return p;
+}
+
+int evalBinary(TokenType op, int a, int b, int* result)
+{
+    unsigned int ua = (unsigned int)a, ub = (unsigned int)b;
+
+    switch (op) {
+    case PLUS:  *result = (int)(ua + ub); break;
+    case MINUS: *result = (int)(ua - ub); break;
+    case TIMES: *result = (int)(ua * ub); break;
+    case OVER:
+        if (b == 0) return FALSE;
+        /* INT_MIN / -1 도 돌아서 INT_MIN (Java 와 같다) */
+        *result = b == -1 ? (int)(0u - ua) : a / b;
+        break;
+    case MOD:
+        if (b == 0) return FALSE;
+        *result = b == -1 ? 0 : a % b;
+        break;
+    /* 시프트 거리는 Java 처럼 아래 5비트만 */
+    case SHL:   *result = (int)(ua << (b & 31)); break;
+    case SHR:   *result = a >> (b & 31); break;
+    case USHR:  *result = (int)(ua >> (b & 31)); break;
+    case LT:    *result = a < b; break;
+    case LTE:   *result = a <= b; break;
+    case GT:    *result = a > b; break;
+    case GTE:   *result = a >= b; break;
+    case EQ:    *result = a == b; break;
+    case NEQ:   *result = a != b; break;
+    default:    return FALSE;
+    }
+    return TRUE;
+}
+
+/* =================================================== */
+/* fold: 트리에서 상수 접기                              */
+/* =================================================== */
+typedef struct {
+    long changed;
+} FoldCtx;
+
+static int isConst(const TreeNode* t)
+{
+    return t != NULL && t->nodekind == ExpK && t->kind.exp == ConstK;
+}
+
+static int isCompareOp(TokenType op)
+{
+    return op >= LT && op <= NEQ;
+}
+
+/* if / while 의 조건 자리 */
+static int isCondition(const TreeNode* p, int slot)
+{
+    return p != NULL && p->nodekind == StmtK && slot == 0 &&
+           (p->kind.stmt == IfK || p->kind.stmt == WhileK);
+}
+
+/* 자식이 먼저 접히므로 (a + 1) * 2 처럼 안쪽부터 올라온다 */
+static void foldPost(FoldCtx* c, TreeNode* t, TreeNode* p, int slot)
+{
+    int v;
+
+    if (t->nodekind != ExpK || t->kind.exp != OpK || t->attr.op == ASSIGN) return;
+    if (!isConst(t->child[0]) || !isConst(t->child[1])) return;
+    /* 비교는 Java 에서 boolean 이므로 조건 자리에서만 접는다 (그 문장은 곧 펼쳐진다) */
+    if (isCompareOp(t->attr.op) && !isCondition(p, slot)) return;
+    if (!evalBinary(t->attr.op, t->child[0]->attr.val, t->child[1]->attr.val, &v)) return;
+
+    t->kind.exp = ConstK;
+    t->attr.val = v;
+    t->type = Integer;
+    t->child[0] = t->child[1] = NULL;
+    c->changed++;
+}
+
+#define FOLD_POST(ctx, t, p, slot)  foldPost(ctx, t, p, slot)
+DEFINE_TREE_VISITOR(foldExprs, FoldCtx, VISIT_NOPRE, VISIT_NOMID, VISIT_NOSIB, FOLD_POST)
+
+/* 반드시 return 으로 끝나는 문장 (뒤의 문장은 닿지 않는다) */
+static int alwaysReturns(const TreeNode* t)
+{
+    if (t == NULL || t->nodekind != StmtK) return FALSE;
+    switch (t->kind.stmt) {
+    case ReturnK:
+        return TRUE;
+    case CmpdK:
+        for (const TreeNode* s = t->child[1]; s != NULL; s = s->sibling)
+            if (alwaysReturns(s)) return TRUE;
+        return FALSE;
+    case IfK:
+        return alwaysReturns(t->child[1]) && alwaysReturns(t->child[2]);
+    default:
+        return FALSE;
+    }
+}
+
+/* *link 부터의 문장 (inList 가 아니면 if / while 몸체 자리의 문장 하나).
+ * 조건이 상수인 if 는 고른 가지로, 한 번도 돌지 않는 while 은 없앤다.
+ * 몸체 자리는 비울 수 없으므로 빈 복합문을 둔다 */
+static void foldStmts(FoldCtx* c, TreeNode** link, int inList)
+{
+    while (*link != NULL) {
+        TreeNode* t = *link;
+        TreeNode* repl = t;
+
+        if (t->nodekind == StmtK) {
+            switch (t->kind.stmt) {
+            case IfK:
+                foldStmts(c, &t->child[1], FALSE);
+                foldStmts(c, &t->child[2], FALSE);
+                if (isConst(t->child[0]))
+                    repl = t->child[0]->attr.val != 0 ? t->child[1] : t->child[2];
+                break;
+            case WhileK:
+                foldStmts(c, &t->child[1], FALSE);
+                if (isConst(t->child[0]) && t->child[0]->attr.val == 0)
+                    repl = NULL;
+                break;
+            case CmpdK:
+                foldStmts(c, &t->child[1], TRUE);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (repl != t) {
+            c->changed++;
+            if (repl == NULL && inList) {
+                *link = t->sibling;
+                continue;
+            }
+            if (repl == NULL) {
+                repl = newStmtNode(CmpdK);
+                repl->lineno = t->lineno;
+            }
+            repl->sibling = t->sibling;
+            *link = repl;
+            t = repl;
+        }
+        if (!inList) return;
+
+        /* return 뒤의 문장은 Java 가 받지 않는다 */
+        if (alwaysReturns(t) && t->sibling != NULL) {
+            for (TreeNode* s = t->sibling; s != NULL; s = s->sibling) c->changed++;
+            t->sibling = NULL;
+        }
+        link = &t->sibling;
+    }
+}
+
+TreeNode* foldConstants(TreeNode* tree, long* changed)
+{
+    FoldCtx c;
+
+    c.changed = 0;
+    foldExprs(&c, tree);
+    for (TreeNode* t = tree; t != NULL; t = t->sibling)
+        if (t->nodekind == DeclK && t->kind.decl == FunK)
+            foldStmts(&c, &t->child[1], FALSE);
+    *changed = c.changed;
+    return tree;
+}
+
+/* =================================================== */
+/* constprop: IR 에서 상수 / 복사 전파                   */
+/* =================================================== */
+
+/* 전역 읽기 전달: 선행 블록이 하나인 블록은 그 블록의 끝 상태를 이어받는다
+ * (확장 기본 블록). 상태는 (전역, 값) 의 스택이고, 호출은 벽을 세운다 */
+typedef struct {
+    BucketListPtr sym;   /* NULL 이면 벽 (호출이 전역을 바꿀 수 있다) */
+    int value;
+} Known;
+
+typedef struct {
+    Known* item;
+    int n, cap;
+} KnownStack;
+
+static void pushKnown(KnownStack* k, BucketListPtr sym, int value)
+{
+    if (k->n == k->cap) {
+        k->cap = k->cap ? k->cap * 2 : 16;
+        k->item = (Known*)realloc(k->item, sizeof(Known) * (size_t)k->cap);
+        if (k->item == NULL) outOfMemory();
+    }
+    k->item[k->n].sym = sym;
+    k->item[k->n].value = value;
+    k->n++;
+}
+
+static int findKnown(const KnownStack* k, BucketListPtr sym)
+{
+    for (int i = k->n - 1; i >= 0; i--) {
+        if (k->item[i].sym == NULL) return -1;
+        if (k->item[i].sym == sym) return k->item[i].value;
+    }
+    return -1;
+}
+
+static long forwardGlobals(IrFunc* f)
+{
+    KnownStack known = { NULL, 0, 0 };
+    int* stack = (int*)allocArray((size_t)f->nblocks, sizeof(int));
+    int* height = (int*)allocArray((size_t)f->nblocks, sizeof(int));
+    long changed = 0;
+
+    for (int root = 0; root < f->nblocks; root++) {
+        int sp = 0;
+        if (f->block[root].rpo < 0 || f->block[root].npred == 1) continue;
+
+        known.n = 0;
+        stack[sp] = root;
+        height[sp++] = 0;
+        while (sp > 0) {
+            IrBlock* b;
+            sp--;
+            b = &f->block[stack[sp]];
+            known.n = height[sp];
+
+            for (int k = 0; k < b->ninst; k++) {
+                IrInst* in = &b->inst[k];
+                int v;
+                switch (in->op) {
+                case IR_LOADG:
+                    v = findKnown(&known, in->sym);
+                    if (v >= 0) {
+                        in->op = IR_COPY;
+                        in->a = v;
+                        in->sym = NULL;
+                        changed++;
+                    }
+                    else
+                        pushKnown(&known, in->sym, in->dst);
+                    break;
+                case IR_STOREG:
+                    pushKnown(&known, in->sym, in->a);
+                    break;
+                case IR_CALL:
+                    pushKnown(&known, NULL, -1);
+                    break;
+                default:
+                    break;
+                }
+            }
+            for (int k = 0; k < b->nsucc; k++) {
+                if (f->block[b->succ[k]].npred != 1) continue;
+                stack[sp] = b->succ[k];
+                height[sp++] = known.n;
+            }
+        }
+    }
+    free(known.item);
+    free(stack);
+    free(height);
+    return changed;
+}
+
+/* 희소 조건부 상수 전파 (Wegman-Zadeck) */
+enum { LAT_UNDEF, LAT_CONST, LAT_VARYING };
+
+typedef struct {
+    IrFunc* f;
+    char* state;         /* 값마다 격자 */
+    int* value;
+    char* execBlock;
+    char* execEdge;      /* 블록 * 2 + 후속 번호 */
+    char* loopHeader;
+    int* useHead;        /* 값 → 첫 사용 */
+    int* useNext;
+    int* useBlock;
+    int* useInst;        /* -1 이면 블록 끝 */
+    int nuse, useCap;
+    int* blockWork;
+    char* inBlockWork;
+    int nblockWork;
+    int* valueWork;
+    char* inValueWork;
+    int nvalueWork;
+} Sccp;
+
+static void addUse(Sccp* s, int v, int block, int inst)
+{
+    if (v < 0) return;
+    if (s->nuse == s->useCap) {
+        s->useCap = s->useCap ? s->useCap * 2 : 64;
+        s->useNext = (int*)realloc(s->useNext, sizeof(int) * (size_t)s->useCap);
+        s->useBlock = (int*)realloc(s->useBlock, sizeof(int) * (size_t)s->useCap);
+        s->useInst = (int*)realloc(s->useInst, sizeof(int) * (size_t)s->useCap);
+        if (s->useNext == NULL || s->useBlock == NULL || s->useInst == NULL) outOfMemory();
+    }
+    s->useBlock[s->nuse] = block;
+    s->useInst[s->nuse] = inst;
+    s->useNext[s->nuse] = s->useHead[v];
+    s->useHead[v] = s->nuse++;
+}
+
+static void pushBlock(Sccp* s, int b)
+{
+    if (s->inBlockWork[b]) return;
+    s->inBlockWork[b] = TRUE;
+    s->blockWork[s->nblockWork++] = b;
+}
+
+static void lower(Sccp* s, int v, int state, int value)
+{
+    if (state == LAT_CONST && s->state[v] == LAT_CONST && s->value[v] != value)
+        state = LAT_VARYING;
+    if (state <= s->state[v]) return;
+    s->state[v] = (char)state;
+    s->value[v] = value;
+    if (!s->inValueWork[v]) {
+        s->inValueWork[v] = TRUE;
+        s->valueWork[s->nvalueWork++] = v;
+    }
+}
+
+static int edgeExec(const Sccp* s, int from, int to)
+{
+    const IrBlock* b = &s->f->block[from];
+    for (int k = 0; k < b->nsucc; k++)
+        if (b->succ[k] == to && s->execEdge[from * 2 + k]) return TRUE;
+    return FALSE;
+}
+
+static void markEdge(Sccp* s, int block, int k)
+{
+    int to = s->f->block[block].succ[k];
+    if (s->execEdge[block * 2 + k]) return;
+    s->execEdge[block * 2 + k] = TRUE;
+    s->execBlock[to] = TRUE;
+    pushBlock(s, to);
+}
+
+static void evalInst(Sccp* s, int block, int k)
+{
+    const IrBlock* b = &s->f->block[block];
+    const IrInst* in = &b->inst[k];
+    int st = LAT_VARYING, val = 0;
+
+    if (in->dst < 0) return;
+    switch (in->op) {
+    case IR_CONST:
+        st = LAT_CONST;
+        val = in->imm;
+        break;
+    case IR_COPY:
+        st = s->state[in->a];
+        val = s->value[in->a];
+        break;
+    case IR_BIN:
+    {
+        int sa = s->state[in->a], sb = s->state[in->b];
+        if (sa == LAT_VARYING || sb == LAT_VARYING) st = LAT_VARYING;
+        else if (sa == LAT_UNDEF || sb == LAT_UNDEF) st = LAT_UNDEF;
+        else if (evalBinary((TokenType)in->imm, s->value[in->a], s->value[in->b], &val))
+            st = LAT_CONST;
+        break;
+    }
+    case IR_PHI:
+        st = LAT_UNDEF;
+        for (int j = 0; j < in->nargs && st != LAT_VARYING; j++) {
+            int a = in->args[j];
+            if (!edgeExec(s, b->pred[j], block) || s->state[a] == LAT_UNDEF) continue;
+            if (s->state[a] == LAT_VARYING) st = LAT_VARYING;
+            else if (st == LAT_UNDEF) {
+                st = LAT_CONST;
+                val = s->value[a];
+            }
+            else if (val != s->value[a]) st = LAT_VARYING;
+        }
+        break;
+    default:
+        break;
+    }
+    lower(s, in->dst, st, val);
+}
+
+static void evalTerm(Sccp* s, int block)
+{
+    const IrBlock* b = &s->f->block[block];
+
+    if (b->term == TERM_JMP)
+        markEdge(s, block, 0);
+    else if (b->term == TERM_BR) {
+        int st = s->state[b->value];
+        if (st == LAT_UNDEF) return;
+        /* while (참) 은 나가는 간선을 남긴다 (Java 가 뒤의 문장을 닿지 않는다고 본다) */
+        if (st == LAT_VARYING || (s->loopHeader[block] && s->value[b->value] != 0)) {
+            markEdge(s, block, 0);
+            markEdge(s, block, 1);
+        }
+        else
+            markEdge(s, block, s->value[b->value] != 0 ? 0 : 1);
+    }
+}
+
+static void markLoops(const IrRegion* r, char* loopHeader)
+{
+    for (; r != NULL; r = r->next) {
+        if (r->kind == IRS_WHILE) loopHeader[r->block] = TRUE;
+        markLoops(r->body, loopHeader);
+        markLoops(r->alt, loopHeader);
+    }
+}
+
+static void runSccp(Sccp* s)
+{
+    IrFunc* f = s->f;
+
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            const IrInst* in = &b->inst[k];
+            addUse(s, in->a, bi, k);
+            addUse(s, in->b, bi, k);
+            if (in->op == IR_CALL || in->op == IR_PHI)
+                for (int j = 0; j < in->nargs; j++) addUse(s, in->args[j], bi, k);
+        }
+        if (b->term == TERM_BR || b->term == TERM_RET) addUse(s, b->value, bi, -1);
+    }
+
+    s->execBlock[0] = TRUE;
+    pushBlock(s, 0);
+    while (s->nblockWork > 0 || s->nvalueWork > 0) {
+        if (s->nblockWork > 0) {
+            int bi = s->blockWork[--s->nblockWork];
+            s->inBlockWork[bi] = FALSE;
+            for (int k = 0; k < f->block[bi].ninst; k++)
+                evalInst(s, bi, k);
+            evalTerm(s, bi);
+        }
+        else {
+            int v = s->valueWork[--s->nvalueWork];
+            s->inValueWork[v] = FALSE;
+            for (int u = s->useHead[v]; u >= 0; u = s->useNext[u]) {
+                if (!s->execBlock[s->useBlock[u]]) continue;
+                if (s->useInst[u] >= 0) evalInst(s, s->useBlock[u], s->useInst[u]);
+                else evalTerm(s, s->useBlock[u]);
+            }
+        }
+    }
+}
+
+static void clearInst(IrInst* in)
+{
+    free(in->args);
+    in->args = NULL;
+    in->nargs = 0;
+    in->a = in->b = -1;
+    in->sym = NULL;
+}
+
+static int findRepl(const int* repl, int v)
+{
+    while (v >= 0 && repl[v] != v) v = repl[v];
+    return v;
+}
+
+/* 복사와 인자가 모두 같은 PHI 를 원래 값으로 바꾼다 */
+static long propagateCopies(IrFunc* f)
+{
+    int* repl = (int*)allocArray((size_t)f->nvalues, sizeof(int));
+    long changed = 0;
+    int again;
+
+    for (int v = 0; v < f->nvalues; v++) repl[v] = v;
+    do {
+        again = FALSE;
+        for (int bi = 0; bi < f->nblocks; bi++) {
+            const IrBlock* b = &f->block[bi];
+            for (int k = 0; k < b->ninst; k++) {
+                const IrInst* in = &b->inst[k];
+                int u = -1, same = TRUE;
+                if (in->dst < 0 || repl[in->dst] != in->dst) continue;
+                if (in->op == IR_COPY)
+                    u = findRepl(repl, in->a);
+                else if (in->op == IR_PHI) {
+                    for (int j = 0; j < in->nargs && same; j++) {
+                        int w = findRepl(repl, in->args[j]);
+                        if (w == in->dst) continue;
+                        if (u < 0) u = w;
+                        else if (w != u) same = FALSE;
+                    }
+                    if (!same) u = -1;
+                }
+                if (u >= 0 && u != in->dst) {
+                    repl[in->dst] = u;
+                    again = TRUE;
+                }
+            }
+        }
+    } while (again);
+
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            IrInst* in = &b->inst[k];
+            if (in->dst >= 0 && repl[in->dst] != in->dst) {
+                in->op = IR_NOP;
+                changed++;
+                continue;
+            }
+            if (in->a >= 0) in->a = findRepl(repl, in->a);
+            if (in->b >= 0) in->b = findRepl(repl, in->b);
+            if (in->op == IR_CALL || in->op == IR_PHI)
+                for (int j = 0; j < in->nargs; j++) in->args[j] = findRepl(repl, in->args[j]);
+        }
+        if (b->term == TERM_BR || b->term == TERM_RET)
+            b->value = findRepl(repl, b->value);
+    }
+    free(repl);
+    return changed;
+}
+
+long propagateConstants(IrFunc* f)
+{
+    Sccp s;
+    int n = f->nvalues > 0 ? f->nvalues : 1;
+    long changed = forwardGlobals(f);
+
+    memset(&s, 0, sizeof(s));
+    s.f = f;
+    s.state = (char*)allocArray((size_t)n, 1);
+    s.value = (int*)allocArray((size_t)n, sizeof(int));
+    s.useHead = (int*)allocArray((size_t)n, sizeof(int));
+    s.valueWork = (int*)allocArray((size_t)n, sizeof(int));
+    s.inValueWork = (char*)allocArray((size_t)n, 1);
+    s.execBlock = (char*)allocArray((size_t)f->nblocks, 1);
+    s.execEdge = (char*)allocArray((size_t)f->nblocks * 2, 1);
+    s.loopHeader = (char*)allocArray((size_t)f->nblocks, 1);
+    s.blockWork = (int*)allocArray((size_t)f->nblocks, sizeof(int));
+    s.inBlockWork = (char*)allocArray((size_t)f->nblocks, 1);
+    for (int v = 0; v < n; v++) s.useHead[v] = -1;
+    markLoops(f->region, s.loopHeader);
+    runSccp(&s);
+
+    /* 한쪽만 도는 분기는 점프로 */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        if (!s.execBlock[bi] || b->term != TERM_BR) continue;
+        if (s.execEdge[bi * 2] && s.execEdge[bi * 2 + 1]) continue;
+        {
+            int k = s.execEdge[bi * 2] ? 0 : 1;
+            irRemovePred(f, b->succ[1 - k], bi);
+            b->succ[0] = b->succ[k];
+            b->nsucc = 1;
+            b->term = TERM_JMP;
+            b->value = -1;
+            changed++;
+        }
+    }
+    /* 닿지 않는 블록은 비운다 */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        if (s.execBlock[bi]) continue;
+        for (int k = 0; k < b->nsucc; k++)
+            irRemovePred(f, b->succ[k], bi);
+        for (int k = 0; k < b->ninst; k++) {
+            clearInst(&b->inst[k]);
+            changed++;
+        }
+        b->ninst = 0;
+        b->nsucc = 0;
+        b->term = TERM_NONE;
+        free(b->pred);
+        b->pred = NULL;
+        b->npred = 0;
+    }
+    /* 상수로 정해진 값은 CONST 로 (PHI 였으면 블록 앞의 PHI 들 뒤로 옮긴다) */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        int nphi = 0;
+        for (int k = 0; k < b->ninst; k++) {
+            IrInst* in = &b->inst[k];
+            if (in->dst >= 0 && in->op != IR_CONST && s.state[in->dst] == LAT_CONST) {
+                clearInst(in);
+                in->op = IR_CONST;
+                in->imm = s.value[in->dst];
+                changed++;
+            }
+        }
+        for (int k = 0; k < b->ninst; k++) {
+            if (b->inst[k].op != IR_PHI) continue;
+            if (k != nphi) {
+                IrInst t = b->inst[k];
+                memmove(&b->inst[nphi + 1], &b->inst[nphi], sizeof(IrInst) * (size_t)(k - nphi));
+                b->inst[nphi] = t;
+            }
+            nphi++;
+        }
+    }
+    changed += propagateCopies(f);
+
+    irCompact(f);
+    irDominators(f);
+    irFixRegions(f, f->region);
+
+    free(s.state);
+    free(s.value);
+    free(s.useHead);
+    free(s.useNext);
+    free(s.useBlock);
+    free(s.useInst);
+    free(s.valueWork);
+    free(s.inValueWork);
+    free(s.execBlock);
+    free(s.execEdge);
+    free(s.loopHeader);
+    free(s.blockWork);
+    free(s.inBlockWork);
+    return changed;
+}
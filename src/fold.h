@@ -0,0 +1,24 @@
+/****************************************************/
+/* File: fold.h                                     */
+/* Constant folding and propagation for C-          */
+/****************************************************/
+
+#ifndef _FOLD_H_
+#define _FOLD_H_
+
+#include "globals.h"
+#include "parse.h"
+#include "ir.h"
+
+/* C- 의 정수 연산: 32비트에서 넘치면 돌고, 나눗셈과 나머지는 0 쪽으로 자른다.
+ * 비교는 0 / 1. 0 으로 나누기는 접지 않고 FALSE */
+int evalBinary(TokenType op, int a, int b, int* result);
+
+/* fold (트리): 상수끼리의 OpK 를 ConstK 로 접고, 조건이 상수인 if / while 을 펼친다 */
+TreeNode* foldConstants(TreeNode* tree, long* changed);
+
+/* constprop (IR): 한 블록 줄기 안의 전역 읽기를 앞의 쓰기 / 읽기 값으로 바꾸고,
+ * 희소 조건부 상수 전파(SCCP)와 복사 전파를 한 뒤 상수 분기와 닿지 않는 블록을 지운다 */
+long propagateConstants(IrFunc* f);
+
+#endif
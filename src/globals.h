@@ -18,6 +18,15 @@
 #define TRUE 1
 #endif
 
+/* 스레드마다 따로 갖는 전역 변수 (병렬 파싱의 작업자마다 하나씩) */
+#if defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
 #define MAXRESERVED 6  /* number of reserved words */
 
 /* Token types for C- */
@@ -37,20 +46,47 @@ typedef enum {
     SEMI, COMMA,
     LPAREN, RPAREN,
     LBRACE, RBRACE,
-    LBRACKET, RBRACKET
+    LBRACKET, RBRACKET,
+
+    /* #include "file" 지시문 (lexeme 은 따옴표 안의 파일 이름) */
+    INCLUDE,
+
+    /* 최적화(rewrite.c)가 만드는 연산: 스캐너는 만들지 않는다.
+     * 나머지와 시프트, >>> 는 부호 없는 오른쪽 시프트 (Java 와 같은 뜻) */
+    MOD, SHL, SHR, USHR
 } TokenType;
 
-/* files */
-extern FILE* source;
-extern FILE* listing;
+/* files (source 는 source.h 참고) */
+extern THREAD_LOCAL FILE* listing;
 
 /* source line number for listing */
-extern int lineno;
+extern THREAD_LOCAL int lineno;
 
 /* trace flags */
 extern int EchoSource;
 extern int TraceScan;
 extern int TraceParse;
-extern int Error;
+extern THREAD_LOCAL int Error;
+
+/* 어휘 분석 스레드 수 (1: 순차, 0: 모든 코어) */
+extern int LexThreads;
+
+/* 최상위 선언 병렬 파싱 스레드 수 (1: 순차, 0: 모든 코어) */
+extern int ParseThreads;
+
+/* 함수 몸체 병렬 의미 분석 스레드 수 (1: 순차, 0: 모든 코어) */
+extern int SemThreads;
+
+/* 분석 뒤 트리를 flat 배열(flat.h)로 바꿔 출력/코드 생성 */
+extern int FlatAst;
+
+/* 스캔 / 파싱 / 의미 분석 / 코드 생성을 각각의 스레드에서 겹쳐 실행 */
+extern int Pipelined;
+
+/* #include 한 헤더의 토큰을 디스크(.cmcache)에도 저장해 다음 실행에서 재사용 */
+extern int TokenCache;
+
+/* 파서가 노드를 만들면서 의미 분석까지 (트리를 두 번 순회하지 않음) */
+extern int FusedCheck;
 
 #endif
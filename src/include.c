@@ -0,0 +1,222 @@
+/****************************************************/
+/* File: include.c                                  */
+/* #include files and header token cache            */
+/****************************************************/
+
+#include "globals.h"
+#include "scan.h"
+#include "intern.h"
+#include "include.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define makeDir(p) _mkdir(p)
+#else
+#include <sys/stat.h>
+#define makeDir(p) mkdir(p, 0777)
+#endif
+
+#define MAXHEADERS  4096        /* Token.file 은 short */
+#define CACHE_DIR   ".cmcache"  /* 디스크 캐시: <내용 해시>.tok */
+#define CACHE_MAGIC "CMTOK01"
+
+/* 헤더 표: 자라도 옮기지 않으므로 파이프라인의 파서가 fileText 로 읽어도 안전 */
+static Header* headers[MAXHEADERS];
+static int nheaders = 0;
+
+static int generation = 1;     /* includeReset 마다 증가 */
+static char* mainPath = NULL;
+
+/* 디스크 캐시 파일 머리 (뒤에 Token 이 count 개) */
+typedef struct {
+    char magic[8];
+    int tokenSize;  /* sizeof(Token): 다른 빌드가 만든 캐시는 버린다 */
+    int srcLen;     /* 헤더 길이 (해시와 함께 확인) */
+    int count;
+} CacheHead;
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in include table\n");
+    exit(1);
+}
+
+/* 64비트 FNV-1a */
+static unsigned long long contentHash(const char* s, int len)
+{
+    unsigned long long h = 14695981039346656037ull;
+    for (int i = 0; i < len; i++)
+        h = (h ^ (unsigned char)s[i]) * 1099511628211ull;
+    return h;
+}
+
+/* base 파일의 디렉터리 + name (name 이 절대 경로면 그대로) */
+static char* resolvePath(const char* base, const char* name, int len)
+{
+    int dirLen = 0;
+    char* p;
+
+    if (base != NULL && name[0] != '/' && name[0] != '\\' && !(len > 1 && name[1] == ':')) {
+        for (int i = 0; base[i] != '\0'; i++)
+            if (base[i] == '/' || base[i] == '\\') dirLen = i + 1;
+    }
+    p = (char*)malloc((size_t)dirLen + (size_t)len + 1);
+    if (p == NULL) outOfMemory();
+    if (dirLen > 0) memcpy(p, base, (size_t)dirLen);
+    memcpy(p + dirLen, name, (size_t)len);
+    p[dirLen + len] = '\0';
+    return p;
+}
+
+static void cacheName(char* buf, size_t n, unsigned long long h, const char* ext)
+{
+    snprintf(buf, n, "%s/%016llx.%s", CACHE_DIR, h, ext);
+}
+
+/* 디스크 캐시에서 토큰을 읽는다. 머리나 토큰이 헤더와 맞지 않으면 FALSE */
+static int loadCache(Header* h, int file)
+{
+    char path[64];
+    CacheHead ch;
+    Token* tok;
+    FILE* fp;
+    int ok;
+
+    if (!TokenCache) return FALSE;
+    cacheName(path, sizeof(path), h->hash, "tok");
+    fp = fopen(path, "rb");
+    if (fp == NULL) return FALSE;
+    if (fread(&ch, sizeof(ch), 1, fp) != 1 || memcmp(ch.magic, CACHE_MAGIC, sizeof(ch.magic)) != 0 ||
+        ch.tokenSize != (int)sizeof(Token) || ch.srcLen != h->src.len ||
+        ch.count < 0 || ch.count > h->src.len) {
+        fclose(fp);
+        return FALSE;
+    }
+    tok = (Token*)malloc(sizeof(Token) * (size_t)(ch.count > 0 ? ch.count : 1));
+    if (tok == NULL) outOfMemory();
+    ok = fread(tok, sizeof(Token), (size_t)ch.count, fp) == (size_t)ch.count;
+    fclose(fp);
+
+    /* lexeme 은 헤더 버퍼를 가리켜야 하고, atom 은 이번 실행의 것으로 */
+    for (int i = 0; ok && i < ch.count; i++) {
+        Token* t = &tok[i];
+        if (t->kind <= ENDFILE || t->kind > INCLUDE || t->line < 1 ||
+            t->start < 0 || t->len < 0 || t->start > h->src.len - t->len) {
+            ok = FALSE;
+            break;
+        }
+        t->file = (short)file;
+        if (t->kind == ID)
+            t->val = internName(h->src.buf + t->start, t->len);
+    }
+    if (!ok) {
+        free(tok);
+        return FALSE;
+    }
+    h->tok = tok;
+    h->count = ch.count;
+    return TRUE;
+}
+
+/* 임시 이름으로 쓴 뒤 바꿔 달아서, 쓰다 만 캐시 파일은 남기지 않는다 */
+static void saveCache(const Header* h)
+{
+    char path[64], tmp[64];
+    CacheHead ch;
+    FILE* fp;
+    int ok;
+
+    if (!TokenCache) return;
+    makeDir(CACHE_DIR);
+    cacheName(path, sizeof(path), h->hash, "tok");
+    cacheName(tmp, sizeof(tmp), h->hash, "tmp");
+    fp = fopen(tmp, "wb");
+    if (fp == NULL) return;
+
+    memset(&ch, 0, sizeof(ch));
+    memcpy(ch.magic, CACHE_MAGIC, sizeof(ch.magic));
+    ch.tokenSize = (int)sizeof(Token);
+    ch.srcLen = h->src.len;
+    ch.count = h->count;
+    ok = fwrite(&ch, sizeof(ch), 1, fp) == 1 &&
+         fwrite(h->tok, sizeof(Token), (size_t)h->count, fp) == (size_t)h->count;
+    ok = (fclose(fp) == 0) && ok;
+    if (ok) {
+        remove(path);
+        ok = rename(tmp, path) == 0;
+    }
+    if (!ok) remove(tmp);
+}
+
+void includeInit(const char* path)
+{
+    free(mainPath);
+    mainPath = resolvePath(NULL, path, (int)strlen(path));
+}
+
+void includeReset(void)
+{
+    generation++;
+}
+
+const Header* includeHeader(int from, const char* name, int len, int* once)
+{
+    SourceFile sf;
+    char* path = resolvePath(from == 0 ? mainPath : headers[from - 1]->path, name, len);
+    unsigned long long hash;
+    Header* h = NULL;
+
+    *once = FALSE;
+    if (!openSource(&sf, path)) {
+        free(path);
+        return NULL;
+    }
+
+    /* 메모리 캐시: 같은 내용을 이미 읽었으면 그 토큰을 그대로 */
+    hash = contentHash(sf.buf, sf.len);
+    for (int i = 0; i < nheaders; i++) {
+        if (headers[i]->hash == hash && headers[i]->src.len == sf.len &&
+            memcmp(headers[i]->src.buf, sf.buf, (size_t)sf.len) == 0) {
+            h = headers[i];
+            break;
+        }
+    }
+    if (h != NULL) {
+        closeSource(&sf);
+        free(path);
+    }
+    else {
+        int file = nheaders + 1;
+        if (nheaders == MAXHEADERS) {
+            fprintf(stderr, "Error: Too many include files\n");
+            exit(1);
+        }
+        h = (Header*)calloc(1, sizeof(Header));
+        if (h == NULL) outOfMemory();
+        h->src = sf;
+        h->path = path;
+        h->hash = hash;
+        /* 디스크 캐시가 없으면 스캔해서 저장 */
+        if (!loadCache(h, file)) {
+            TokenArray ta = { NULL, 0, 0 };
+            lexHeader(&h->src, file, &ta);
+            h->tok = ta.tok;
+            h->count = ta.count;
+            saveCache(h);
+        }
+        headers[nheaders++] = h;
+    }
+
+    /* include guard: 한 컴파일에서 같은 헤더는 한 번만 */
+    if (h->generation == generation) {
+        *once = TRUE;
+        return NULL;
+    }
+    h->generation = generation;
+    return h;
+}
+
+const char* fileText(int file)
+{
+    return file == 0 ? source.buf : headers[file - 1]->src.buf;
+}
@@ -0,0 +1,37 @@
+/****************************************************/
+/* File: include.h                                  */
+/* #include files and header token cache            */
+/****************************************************/
+
+#ifndef _INCLUDE_H_
+#define _INCLUDE_H_
+
+#include "scan.h"
+
+/* #include 한 헤더 하나. 내용이 같으면(64비트 해시) 같은 헤더로 보고
+ * 한 번 만든 토큰을 실행 내내 재사용한다 */
+typedef struct {
+    SourceFile src;     /* 헤더 내용 (토큰의 lexeme 이 가리킴) */
+    char* path;         /* 처음 읽은 경로 (중첩 #include 의 기준 디렉터리) */
+    unsigned long long hash;
+    Token* tok;         /* 헤더 자신의 토큰 (ENDFILE 제외, 중첩 #include 는 INCLUDE) */
+    int count;
+    int generation;     /* 마지막으로 포함된 컴파일 (include-once) */
+} Header;
+
+/* 컴파일할 소스의 경로 (첫 #include 의 기준 디렉터리) */
+void includeInit(const char* mainPath);
+
+/* 새 컴파일 시작: 포함 기록을 비운다 (토큰 캐시는 유지) */
+void includeReset(void);
+
+/* 파일 from 안의 #include "name[0..len)".
+ * 이번 컴파일에서 처음이면 헤더를, 이미 포함했으면 *once = TRUE 로 NULL,
+ * 열 수 없으면 *once = FALSE 로 NULL 을 돌려준다 */
+const Header* includeHeader(int from, const char* name, int len, int* once);
+
+/* 토큰 file 번호의 버퍼 (0 은 source) */
+const char* fileText(int file);
+#define tokText(t) (fileText((t)->file) + (t)->start)
+
+#endif
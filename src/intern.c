@@ -0,0 +1,140 @@
+/****************************************************/
+/* File: intern.c                                   */
+/* Identifier interning for the C- compiler         */
+/****************************************************/
+
+#include "globals.h"
+#include "intern.h"
+#include <stdatomic.h>
+
+#define NAMEBLOCK 65536  /* 문자열 저장 블록 크기 */
+#define NAMECHUNK 4096   /* atom → 이름 표의 조각 크기 */
+#define MAXCHUNKS 65536
+
+/* atom → 이름: 고정 크기 조각으로 나눠 두어 표가 자라도 옮기지 않는다.
+ * (파이프라인에서 스캐너가 이름을 등록하는 동안 다른 스레드가 atomName 을 읽는다) */
+static const char** names[MAXCHUNKS];
+static int* nameLens = NULL;
+static unsigned int* nameHash = NULL;
+static atomic_int natoms = 0;  /* 등록은 한 스레드, atomName 은 어느 스레드나 */
+static int atomCap = 0;
+
+/* 이름 → atom: 2의 거듭제곱 크기 open addressing 표 (빈 칸 -1) */
+static int* slots = NULL;
+static unsigned int slotMask = 0;
+
+/* 문자열은 블록에 이어 붙여 저장 (블록은 옮기지 않으므로 포인터가 안정적) */
+static char* block = NULL;
+static int blockUsed = NAMEBLOCK;
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in name table\n");
+    exit(1);
+}
+
+unsigned int internHash(const char* s, int len)
+{
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < len; i++)
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    return h;
+}
+
+static const char* storeName(const char* s, int len)
+{
+    char* p;
+
+    if (len + 1 > NAMEBLOCK) {
+        /* 아주 긴 이름은 따로 할당 */
+        p = (char*)malloc((size_t)len + 1);
+        if (p == NULL) outOfMemory();
+    }
+    else {
+        if (len + 1 > NAMEBLOCK - blockUsed) {
+            block = (char*)malloc(NAMEBLOCK);
+            if (block == NULL) outOfMemory();
+            blockUsed = 0;
+        }
+        p = block + blockUsed;
+        blockUsed += len + 1;
+    }
+    memcpy(p, s, (size_t)len);
+    p[len] = '\0';
+    return p;
+}
+
+static void growSlots(void)
+{
+    unsigned int size = slotMask ? (slotMask + 1) * 2 : 1024;
+    int* p = (int*)malloc(sizeof(int) * size);
+    if (p == NULL) outOfMemory();
+    for (unsigned int i = 0; i < size; i++)
+        p[i] = -1;
+    for (int a = 0; a < natoms; a++) {
+        unsigned int h = nameHash[a] & (size - 1);
+        while (p[h] >= 0)
+            h = (h + 1) & (size - 1);
+        p[h] = a;
+    }
+    free(slots);
+    slots = p;
+    slotMask = size - 1;
+}
+
+int internName(const char* s, int len)
+{
+    return internNameHashed(s, len, internHash(s, len));
+}
+
+int internNameHashed(const char* s, int len, unsigned int h)
+{
+    unsigned int i;
+    int a;
+
+    if (slots == NULL || (unsigned int)natoms * 2 >= slotMask)
+        growSlots();
+
+    for (i = h & slotMask; (a = slots[i]) >= 0; i = (i + 1) & slotMask) {
+        if (nameHash[a] == h && nameLens[a] == len && memcmp(names[a / NAMECHUNK][a % NAMECHUNK], s, (size_t)len) == 0)
+            return a;
+    }
+
+    /* 새 이름 등록 */
+    if (natoms == atomCap) {
+        atomCap = atomCap ? atomCap * 2 : 1024;
+        nameLens = (int*)realloc(nameLens, sizeof(int) * atomCap);
+        nameHash = (unsigned int*)realloc(nameHash, sizeof(unsigned int) * atomCap);
+        if (nameLens == NULL || nameHash == NULL) outOfMemory();
+    }
+    a = natoms;
+    if (a % NAMECHUNK == 0) {
+        if (a / NAMECHUNK >= MAXCHUNKS) outOfMemory();
+        names[a / NAMECHUNK] = (const char**)malloc(sizeof(char*) * NAMECHUNK);
+        if (names[a / NAMECHUNK] == NULL) outOfMemory();
+    }
+    names[a / NAMECHUNK][a % NAMECHUNK] = storeName(s, len);
+    atomic_store_explicit(&natoms, a + 1, memory_order_release);
+    nameLens[a] = len;
+    nameHash[a] = h;
+    slots[i] = a;
+    return a;
+}
+
+void initIntern(void)
+{
+    if (natoms > 0) return;
+    internName("input", 5);   /* ATOM_INPUT */
+    internName("output", 6);  /* ATOM_OUTPUT */
+    internName("main", 4);    /* ATOM_MAIN */
+}
+
+const char* atomName(int atom)
+{
+    return (atom >= 0 && atom < atomic_load_explicit(&natoms, memory_order_acquire)) ? names[atom / NAMECHUNK][atom % NAMECHUNK] : "?";
+}
+
+int atomCount(void)
+{
+    return natoms;
+}
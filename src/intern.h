@@ -0,0 +1,30 @@
+/****************************************************/
+/* File: intern.h                                   */
+/* Identifier interning for the C- compiler         */
+/****************************************************/
+
+#ifndef _INTERN_H_
+#define _INTERN_H_
+
+/* 서로 다른 lexeme 마다 고유한 정수(atom)를 하나씩 준다.
+ * 이름 비교는 정수 비교가 되고, 같은 이름은 한 번만 저장된다.
+ * atomName() 이 돌려주는 문자열은 프로그램이 끝날 때까지 유효하다 */
+
+/* 미리 등록되는 이름 (initIntern 에서 이 순서로 등록) */
+#define ATOM_INPUT  0
+#define ATOM_OUTPUT 1
+#define ATOM_MAIN   2
+
+void initIntern(void);
+
+/* s[0..len) 의 atom (처음 보는 이름이면 새로 등록) */
+int internName(const char* s, int len);
+
+/* 해시를 미리 계산해 둔 경우 (병렬 스캔: 해시는 작업자가, 등록은 한 스레드가) */
+unsigned int internHash(const char* s, int len);
+int internNameHashed(const char* s, int len, unsigned int h);
+
+const char* atomName(int atom);
+int atomCount(void);
+
+#endif
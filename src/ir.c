@@ -0,0 +1,967 @@
+/****************************************************/
+/* File: ir.c                                       */
+/* Three-address SSA IR for the C- compiler         */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "intern.h"
+#include "arena.h"
+#include "visit.h"
+#include "ir.h"
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in IR\n");
+    exit(1);
+}
+
+/* *p 를 n 개 이상 담도록 늘린다 (두 배씩) */
+static void* growArray(void* p, int* cap, int n, size_t elem)
+{
+    int c = *cap ? *cap : 8;
+    if (n <= *cap) return p;
+    while (c < n) c *= 2;
+    p = realloc(p, elem * (size_t)c);
+    if (p == NULL) outOfMemory();
+    *cap = c;
+    return p;
+}
+
+static int* allocInts(int n, int fill)
+{
+    int* p = (int*)malloc(sizeof(int) * (size_t)(n > 0 ? n : 1));
+    if (p == NULL) outOfMemory();
+    for (int i = 0; i < n; i++) p[i] = fill;
+    return p;
+}
+
+/* =================================================== */
+/* 값, 변수, 블록, 명령                                 */
+/* =================================================== */
+
+int irNewValue(IrFunc* f, int var)
+{
+    f->valueVar = (int*)growArray(f->valueVar, &f->valueCap, f->nvalues + 1, sizeof(int));
+    f->valueVar[f->nvalues] = var;
+    return f->nvalues++;
+}
+
+static int newVar(IrFunc* f, int atom, int param)
+{
+    f->var = (IrVar*)growArray(f->var, &f->varCap, f->nvars + 1, sizeof(IrVar));
+    f->var[f->nvars].atom = atom;
+    f->var[f->nvars].param = param;
+    return f->nvars++;
+}
+
+int irNewBlock(IrFunc* f)
+{
+    IrBlock* b;
+
+    f->block = (IrBlock*)growArray(f->block, &f->blockCap, f->nblocks + 1, sizeof(IrBlock));
+    b = &f->block[f->nblocks];
+    memset(b, 0, sizeof(IrBlock));
+    b->term = TERM_NONE;
+    b->value = -1;
+    b->idom = -1;
+    b->rpo = -1;
+    return f->nblocks++;
+}
+
+IrInst* irAppend(IrFunc* f, int block, IrOp op)
+{
+    IrBlock* b = &f->block[block];
+    IrInst* in;
+
+    b->inst = (IrInst*)growArray(b->inst, &b->cap, b->ninst + 1, sizeof(IrInst));
+    in = &b->inst[b->ninst++];
+    memset(in, 0, sizeof(IrInst));
+    in->op = op;
+    in->dst = in->a = in->b = -1;
+    return in;
+}
+
+/* 블록 맨 앞에 (PHI 와 미정의 값) */
+static IrInst* prependInst(IrFunc* f, int block, IrOp op)
+{
+    IrBlock* b = &f->block[block];
+
+    irAppend(f, block, op);
+    memmove(&b->inst[1], &b->inst[0], sizeof(IrInst) * (size_t)(b->ninst - 1));
+    memset(&b->inst[0], 0, sizeof(IrInst));
+    b->inst[0].op = op;
+    b->inst[0].dst = b->inst[0].a = b->inst[0].b = -1;
+    return &b->inst[0];
+}
+
+void irCompact(IrFunc* f)
+{
+    for (int i = 0; i < f->nblocks; i++) {
+        IrBlock* b = &f->block[i];
+        int n = 0;
+        for (int k = 0; k < b->ninst; k++) {
+            if (b->inst[k].op == IR_NOP) {
+                free(b->inst[k].args);
+                continue;
+            }
+            b->inst[n++] = b->inst[k];
+        }
+        b->ninst = n;
+    }
+}
+
+int irPredIndex(const IrBlock* b, int pred)
+{
+    for (int k = 0; k < b->npred; k++)
+        if (b->pred[k] == pred) return k;
+    return -1;
+}
+
+void irRemovePred(IrFunc* f, int block, int pred)
+{
+    IrBlock* b = &f->block[block];
+    int j = irPredIndex(b, pred);
+
+    if (j < 0) return;
+    for (int k = j; k + 1 < b->npred; k++)
+        b->pred[k] = b->pred[k + 1];
+    b->npred--;
+    for (int k = 0; k < b->ninst && b->inst[k].op == IR_PHI; k++) {
+        IrInst* in = &b->inst[k];
+        for (int m = j; m + 1 < in->nargs; m++)
+            in->args[m] = in->args[m + 1];
+        in->nargs--;
+    }
+}
+
+static int regionEntry(const IrRegion* r)
+{
+    while (r != NULL && r->kind == IRS_SEQ) r = r->body;
+    return r != NULL ? r->block : -1;
+}
+
+/* 접힌 분기를 구조 트리에 반영한다: 상수 if 는 고른 가지의 순차로,
+ * 한 번도 돌지 않는 while 은 머리 블록만. 닿지 않는 항목은 뺀다 */
+void irFixRegions(const IrFunc* f, IrRegion* seq)
+{
+    IrRegion** link = &seq->body;
+
+    while (*link != NULL) {
+        IrRegion* r = *link;
+        int entry = regionEntry(r);
+
+        if (entry >= 0 && f->block[entry].rpo < 0) {
+            *link = r->next;
+            continue;
+        }
+        if (r->kind == IRS_IF && f->block[r->block].term == TERM_JMP) {
+            IrRegion* taken = f->block[r->block].succ[0] == regionEntry(r->body) ? r->body : r->alt;
+            r->kind = IRS_SEQ;
+            r->body = taken->body;
+            r->alt = NULL;
+        }
+        else if (r->kind == IRS_WHILE && f->block[r->block].term == TERM_JMP) {
+            r->kind = IRS_BLOCK;
+            r->body = NULL;
+        }
+
+        if (r->kind == IRS_SEQ) irFixRegions(f, r);
+        else if (r->kind == IRS_IF) {
+            irFixRegions(f, r->body);
+            irFixRegions(f, r->alt);
+        }
+        else if (r->kind == IRS_WHILE || r->kind == IRS_LOOP)
+            irFixRegions(f, r->body);
+        link = &r->next;
+    }
+}
+
+static void setJump(IrFunc* f, int from, int to)
+{
+    IrBlock* b = &f->block[from];
+    b->term = TERM_JMP;
+    b->succ[0] = to;
+    b->nsucc = 1;
+}
+
+/* =================================================== */
+/* AST → IR                                             */
+/* =================================================== */
+
+typedef struct {
+    IrFunc* f;
+    int cur;            /* 지금 채우는 블록 (항상 지금 SEQ 의 마지막 BLOCK) */
+    IrRegion* seq;      /* 지금 채우는 SEQ */
+    IrRegion* tail;     /* 그 마지막 항목 */
+    int done;           /* return 뒤: 같은 목록의 남은 문장은 닿지 않는다 */
+    int* stack;         /* 식의 값 스택 */
+    int sp, cap;
+    int line;
+} Lower;
+
+IrRegion* irNewRegion(IrRegionKind kind, int block)
+{
+    IrRegion* r = (IrRegion*)arenaAlloc(curArena, sizeof(IrRegion));
+    r->kind = kind;
+    r->block = block;
+    r->body = r->alt = r->next = NULL;
+    return r;
+}
+
+static void addRegion(Lower* L, IrRegion* r)
+{
+    if (L->tail == NULL) L->seq->body = r;
+    else L->tail->next = r;
+    L->tail = r;
+}
+
+static void push(Lower* L, int v)
+{
+    L->stack = (int*)growArray(L->stack, &L->cap, L->sp + 1, sizeof(int));
+    L->stack[L->sp++] = v;
+}
+
+/* void 호출의 "값" 은 0 으로 본다 (의미 분석이 대부분 막는다) */
+static int valueOf(Lower* L, int v)
+{
+    if (v < 0) {
+        IrInst* in = irAppend(L->f, L->cur, IR_CONST);
+        in->dst = v = irNewValue(L->f, -1);
+        in->imm = 0;
+        in->line = L->line;
+    }
+    return v;
+}
+
+static int pop(Lower* L)
+{
+    return valueOf(L, L->stack[--L->sp]);
+}
+
+static int exprPre(TreeNode* t)
+{
+    /* 대입의 왼쪽 변수는 읽지 않는다 */
+    if (t->nodekind == ExpK && t->kind.exp == OpK && t->attr.op == ASSIGN)
+        return 1 << 1;
+    return VISIT_ALL;
+}
+
+static void exprPost(Lower* L, TreeNode* t)
+{
+    IrFunc* f = L->f;
+    BucketListPtr s = t->sym;
+    IrInst* in;
+
+    L->line = t->lineno;
+    switch (t->kind.exp) {
+    case ConstK:
+        in = irAppend(f, L->cur, IR_CONST);
+        in->dst = irNewValue(f, -1);
+        in->imm = t->attr.val;
+        break;
+
+    case IdK:
+        if (s != NULL && s->scope > 0 && s->index >= 0) {
+            in = irAppend(f, L->cur, IR_LOADV);
+            in->imm = s->index;
+            in->dst = irNewValue(f, s->index);
+        }
+        else if (s != NULL && s->node != NULL && s->node->kind.decl == VarK) {
+            in = irAppend(f, L->cur, IR_LOADG);
+            in->sym = s;
+            in->dst = irNewValue(f, -1);
+        }
+        else {
+            /* 함수 이름을 값으로 쓴 경우 */
+            in = irAppend(f, L->cur, IR_CONST);
+            in->dst = irNewValue(f, -1);
+            in->imm = 0;
+        }
+        break;
+
+    case OpK:
+        if (t->attr.op == ASSIGN) {
+            int v = pop(L);
+            BucketListPtr ls = t->child[0] != NULL ? t->child[0]->sym : NULL;
+            if (ls != NULL && ls->scope > 0 && ls->index >= 0) {
+                in = irAppend(f, L->cur, IR_STOREV);
+                in->imm = ls->index;
+                in->a = v;
+            }
+            else if (ls != NULL) {
+                in = irAppend(f, L->cur, IR_STOREG);
+                in->sym = ls;
+                in->a = v;
+            }
+            else
+                in = NULL;
+            if (in != NULL) in->line = t->lineno;
+            push(L, v);
+            return;
+        }
+        else {
+            int b = pop(L);
+            int a = pop(L);
+            in = irAppend(f, L->cur, IR_BIN);
+            in->imm = (int)t->attr.op;
+            in->a = a;
+            in->b = b;
+            in->dst = irNewValue(f, -1);
+        }
+        break;
+
+    case CallK:
+    {
+        int n = 0;
+        int* args;
+        for (TreeNode* p = t->child[0]; p != NULL; p = p->sibling) n++;
+        args = allocInts(n, -1);
+        for (int k = n - 1; k >= 0; k--)
+            args[k] = pop(L);
+        in = irAppend(f, L->cur, IR_CALL);
+        in->sym = s;
+        in->nargs = n;
+        in->args = args;
+        in->dst = (s != NULL && s->type == Integer) ? irNewValue(f, -1) : -1;
+        break;
+    }
+
+    default:
+        return;
+    }
+    in->line = t->lineno;
+    push(L, in->dst);
+}
+
+#define LOWER_PRE(ctx, t, p, slot, d)  exprPre(t)
+#define LOWER_POST(ctx, t, p, slot)    exprPost(ctx, t)
+DEFINE_TREE_VISITOR(lowerTree, Lower, LOWER_PRE, VISIT_NOMID, VISIT_NOSIB, LOWER_POST)
+
+/* 식 하나를 지금 블록에 내리고 그 값을 돌려준다 (void 호출이면 -1) */
+static int lowerExpr(Lower* L, TreeNode* t)
+{
+    TreeNode* sib = t->sibling;
+    int base = L->sp;
+    int v;
+
+    /* 방문기는 뿌리의 형제까지 돌므로 잠시 떼어 둔다 */
+    t->sibling = NULL;
+    lowerTree(L, t);
+    t->sibling = sib;
+    v = L->stack[--L->sp];
+    L->sp = base;
+    return v;
+}
+
+static void lowerStmt(Lower* L, TreeNode* t);
+
+static void lowerStmts(Lower* L, TreeNode* t)
+{
+    for (; t != NULL && !L->done; t = t->sibling)
+        lowerStmt(L, t);
+}
+
+/* 새 블록 b 에서 시작하는 SEQ 로 문장 하나를 내린다. 끝난 블록을 돌려준다 */
+static int lowerBranch(Lower* L, int b, TreeNode* stmt, IrRegion** out, int* done)
+{
+    IrRegion* savedSeq = L->seq;
+    IrRegion* savedTail = L->tail;
+    int end;
+
+    L->seq = irNewRegion(IRS_SEQ, -1);
+    L->tail = NULL;
+    addRegion(L, irNewRegion(IRS_BLOCK, b));
+    L->cur = b;
+    L->done = FALSE;
+    if (stmt != NULL) lowerStmt(L, stmt);
+
+    *out = L->seq;
+    *done = L->done;
+    end = L->cur;
+    L->seq = savedSeq;
+    L->tail = savedTail;
+    L->done = FALSE;
+    return end;
+}
+
+static void continueIn(Lower* L, int b)
+{
+    addRegion(L, irNewRegion(IRS_BLOCK, b));
+    L->cur = b;
+}
+
+static void lowerStmt(Lower* L, TreeNode* t)
+{
+    IrFunc* f = L->f;
+
+    if (t->nodekind == ExpK) {
+        lowerExpr(L, t);
+        return;
+    }
+    if (t->nodekind != StmtK) return;
+
+    switch (t->kind.stmt) {
+    case CmpdK:
+        for (TreeNode* d = t->child[0]; d != NULL; d = d->sibling)
+            if (d->sym != NULL) d->sym->index = newVar(f, d->attr.atom, -1);
+        lowerStmts(L, t->child[1]);
+        break;
+
+    case IfK:
+    {
+        IrRegion* r;
+        int cond = valueOf(L, lowerExpr(L, t->child[0]));
+        int condBlock = L->cur;
+        int thenB = irNewBlock(f);
+        int elseB = irNewBlock(f);
+        int thenEnd, elseEnd, thenDone, elseDone;
+
+        f->block[condBlock].term = TERM_BR;
+        f->block[condBlock].value = cond;
+        f->block[condBlock].succ[0] = thenB;
+        f->block[condBlock].succ[1] = elseB;
+        f->block[condBlock].nsucc = 2;
+
+        /* else 가 없어도 빈 블록을 두어 임계 간선이 생기지 않게 한다 */
+        r = irNewRegion(IRS_IF, condBlock);
+        thenEnd = lowerBranch(L, thenB, t->child[1], &r->body, &thenDone);
+        elseEnd = lowerBranch(L, elseB, t->child[2], &r->alt, &elseDone);
+        addRegion(L, r);
+
+        if (thenDone && elseDone) {
+            L->done = TRUE;
+            break;
+        }
+        {
+            int join = irNewBlock(f);
+            if (!thenDone) setJump(f, thenEnd, join);
+            if (!elseDone) setJump(f, elseEnd, join);
+            continueIn(L, join);
+        }
+        break;
+    }
+
+    case WhileK:
+    {
+        IrRegion* r;
+        int header = irNewBlock(f);
+        int bodyB, bodyEnd, bodyDone, exitB, cond;
+
+        setJump(f, L->cur, header);
+        r = irNewRegion(IRS_WHILE, header);
+        L->cur = header;
+        cond = valueOf(L, lowerExpr(L, t->child[0]));
+
+        bodyB = irNewBlock(f);
+        bodyEnd = lowerBranch(L, bodyB, t->child[1], &r->body, &bodyDone);
+        if (!bodyDone) setJump(f, bodyEnd, header);
+
+        exitB = irNewBlock(f);
+        f->block[header].term = TERM_BR;
+        f->block[header].value = cond;
+        f->block[header].succ[0] = bodyB;
+        f->block[header].succ[1] = exitB;
+        f->block[header].nsucc = 2;
+        addRegion(L, r);
+        continueIn(L, exitB);
+        break;
+    }
+
+    case ReturnK:
+    {
+        int v = -1;
+        if (t->child[0] != NULL) {
+            v = valueOf(L, lowerExpr(L, t->child[0]));
+        }
+        f->block[L->cur].term = TERM_RET;
+        f->block[L->cur].value = v;
+        L->done = TRUE;
+        break;
+    }
+    }
+}
+
+void lowerFunction(TreeNode* fun, IrFunc* f)
+{
+    Lower L;
+    int entry, k = 0;
+
+    memset(f, 0, sizeof(IrFunc));
+    f->decl = fun;
+    memset(&L, 0, sizeof(L));
+    L.f = f;
+    L.seq = f->region = irNewRegion(IRS_SEQ, -1);
+    entry = irNewBlock(f);
+    continueIn(&L, entry);
+
+    /* 파라미터: 들어온 값을 변수에 넣어 두고 시작 */
+    for (TreeNode* p = fun->child[0]; p != NULL; p = p->sibling, k++) {
+        int var = newVar(f, p->attr.atom, k);
+        int v = irNewValue(f, var);
+        IrInst* in;
+        if (p->sym != NULL) p->sym->index = var;
+        in = irAppend(f, entry, IR_PARAM);
+        in->imm = k;
+        in->dst = v;
+        in->line = p->lineno;
+        in = irAppend(f, entry, IR_STOREV);
+        in->imm = var;
+        in->a = v;
+        in->line = p->lineno;
+    }
+    f->nparams = k;
+
+    if (fun->child[1] != NULL) lowerStmt(&L, fun->child[1]);
+
+    /* 끝까지 온 int 함수는 0 을 돌려준다 (Java 는 return 이 빠지면 컴파일하지 않는다) */
+    if (!L.done) {
+        int v = -1;
+        if (fun->type == Integer) {
+            IrInst* in = irAppend(f, L.cur, IR_CONST);
+            in->dst = v = irNewValue(f, -1);
+            in->imm = 0;
+        }
+        f->block[L.cur].term = TERM_RET;
+        f->block[L.cur].value = v;
+    }
+    free(L.stack);
+}
+
+/* =================================================== */
+/* CFG 와 지배자                                        */
+/* =================================================== */
+
+/* 두 지배자 후보의 공통 조상 (Cooper, Harvey, Kennedy) */
+static int intersect(const IrFunc* f, int a, int b)
+{
+    while (a != b) {
+        while (f->block[a].rpo > f->block[b].rpo) a = f->block[a].idom;
+        while (f->block[b].rpo > f->block[a].rpo) b = f->block[b].idom;
+    }
+    return a;
+}
+
+/* 역 후위 순서의 블록 번호 (order[0] 은 진입). 닿는 블록 수를 돌려준다 */
+static int reversePostorder(IrFunc* f, int* order)
+{
+    int* stack = allocInts(f->nblocks, 0);
+    int* edge = allocInts(f->nblocks, 0);
+    int* seen = allocInts(f->nblocks, FALSE);
+    int sp = 0, n = 0, count;
+
+    stack[sp++] = 0;
+    seen[0] = TRUE;
+    while (sp > 0) {
+        int b = stack[sp - 1];
+        if (edge[sp - 1] < f->block[b].nsucc) {
+            int s = f->block[b].succ[edge[sp - 1]++];
+            if (!seen[s]) {
+                seen[s] = TRUE;
+                stack[sp] = s;
+                edge[sp] = 0;
+                sp++;
+            }
+            continue;
+        }
+        order[n++] = b;   /* 후위 */
+        sp--;
+    }
+    count = n;
+    for (int i = 0; i < n / 2; i++) {
+        int t = order[i];
+        order[i] = order[n - 1 - i];
+        order[n - 1 - i] = t;
+    }
+    free(stack);
+    free(edge);
+    free(seen);
+    return count;
+}
+
+void buildCfg(IrFunc* f)
+{
+    for (int i = 0; i < f->nblocks; i++) {
+        IrBlock* b = &f->block[i];
+        free(b->pred);
+        b->pred = NULL;
+        b->npred = 0;
+        b->idom = -1;
+        b->rpo = -1;
+        if (b->term == TERM_RET || b->term == TERM_NONE) b->nsucc = 0;
+    }
+    /* 선행 블록: 블록 번호 순서 */
+    for (int i = 0; i < f->nblocks; i++) {
+        IrBlock* b = &f->block[i];
+        for (int k = 0; k < b->nsucc; k++) {
+            IrBlock* s = &f->block[b->succ[k]];
+            s->pred = (int*)realloc(s->pred, sizeof(int) * (size_t)(s->npred + 1));
+            if (s->pred == NULL) outOfMemory();
+            s->pred[s->npred++] = i;
+        }
+    }
+
+    irDominators(f);
+}
+
+void irDominators(IrFunc* f)
+{
+    int* order = allocInts(f->nblocks, -1);
+    int n, changed;
+
+    for (int i = 0; i < f->nblocks; i++) {
+        f->block[i].idom = -1;
+        f->block[i].rpo = -1;
+    }
+    n = reversePostorder(f, order);
+    for (int i = 0; i < n; i++)
+        f->block[order[i]].rpo = i;
+
+    f->block[0].idom = 0;
+    do {
+        changed = FALSE;
+        for (int i = 1; i < n; i++) {
+            IrBlock* b = &f->block[order[i]];
+            int idom = -1;
+            for (int k = 0; k < b->npred; k++) {
+                int p = b->pred[k];
+                if (f->block[p].idom < 0) continue;
+                idom = idom < 0 ? p : intersect(f, p, idom);
+            }
+            if (idom != b->idom) {
+                b->idom = idom;
+                changed = TRUE;
+            }
+        }
+    } while (changed);
+    free(order);
+}
+
+/* =================================================== */
+/* SSA (Cytron 등): 지배 경계에 PHI, 지배자 트리를 따라 이름 바꾸기 */
+/* =================================================== */
+
+typedef struct {
+    int* item;
+    int n, cap;
+} IntList;
+
+static void listAdd(IntList* l, int v)
+{
+    l->item = (int*)growArray(l->item, &l->cap, l->n + 1, sizeof(int));
+    l->item[l->n++] = v;
+}
+
+/* 값 v 가 다른 값으로 바뀌었으면 끝까지 따라간다 */
+static int resolve(const int* repl, int v)
+{
+    while (v >= 0 && repl[v] >= 0) v = repl[v];
+    return v;
+}
+
+void buildSsa(IrFunc* f)
+{
+    int nb = f->nblocks, nv = f->nvars;
+    IntList* df = (IntList*)calloc((size_t)(nb > 0 ? nb : 1), sizeof(IntList));
+    IntList* defs = (IntList*)calloc((size_t)(nv > 0 ? nv : 1), sizeof(IntList));
+    IntList* kids = (IntList*)calloc((size_t)(nb > 0 ? nb : 1), sizeof(IntList));
+    int* mark = allocInts(nb, -1);
+    int* placed = allocInts(nb, -1);
+    int* work = allocInts(nb, 0);
+    int* cur;
+    int* repl;
+    int undef;
+    IrInst* in;
+    IntList undo = { NULL, 0, 0 };
+    int* stack;
+    int* phase;
+    int* logTop;
+    int sp;
+
+    if (df == NULL || defs == NULL || kids == NULL) outOfMemory();
+    buildCfg(f);
+
+    /* 1. 지배 경계: 합류 블록 b 의 선행 블록에서 idom(b) 까지 올라가며 */
+    for (int b = 0; b < nb; b++) {
+        IrBlock* bb = &f->block[b];
+        if (bb->rpo < 0 || bb->npred < 2) continue;
+        for (int k = 0; k < bb->npred; k++) {
+            int r = bb->pred[k];
+            if (f->block[r].rpo < 0) continue;
+            while (r != bb->idom) {
+                if (mark[r] != b) {
+                    mark[r] = b;
+                    listAdd(&df[r], b);
+                }
+                r = f->block[r].idom;
+            }
+        }
+    }
+
+    /* 2. 변수마다 정의 블록에서 시작해 지배 경계의 닫힘에 PHI */
+    for (int b = 0; b < nb; b++) {
+        if (f->block[b].rpo < 0) continue;
+        for (int k = 0; k < f->block[b].ninst; k++) {
+            in = &f->block[b].inst[k];
+            if (in->op == IR_STOREV && (defs[in->imm].n == 0 || defs[in->imm].item[defs[in->imm].n - 1] != b))
+                listAdd(&defs[in->imm], b);
+        }
+    }
+    for (int v = 0; v < nv; v++) {
+        int wn = 0;
+        for (int k = 0; k < defs[v].n; k++) {
+            work[wn++] = defs[v].item[k];
+            mark[defs[v].item[k]] = nb + v;   /* 작업 목록에 들어갔다 */
+        }
+        while (wn > 0) {
+            int x = work[--wn];
+            for (int k = 0; k < df[x].n; k++) {
+                int y = df[x].item[k];
+                if (placed[y] == v) continue;
+                placed[y] = v;
+                in = prependInst(f, y, IR_PHI);
+                in->imm = v;
+                in->dst = irNewValue(f, v);
+                in->nargs = f->block[y].npred;
+                in->args = allocInts(in->nargs, -1);
+                if (mark[y] != nb + v) {
+                    mark[y] = nb + v;
+                    work[wn++] = y;
+                }
+            }
+        }
+    }
+
+    /* 3. 이름 바꾸기: 변수의 현재 값(cur)과 되돌리기 기록(undo)으로 지배자 트리를 전위 순회 */
+    in = prependInst(f, 0, IR_CONST);     /* 초기화하지 않은 변수의 값 */
+    in->dst = undef = irNewValue(f, -1);
+    in->imm = 0;
+    cur = allocInts(nv, undef);
+    repl = allocInts(f->nvalues, -1);
+    for (int b = 1; b < nb; b++)
+        if (f->block[b].rpo >= 0 && f->block[b].idom >= 0)
+            listAdd(&kids[f->block[b].idom], b);
+
+    stack = allocInts(nb, 0);
+    phase = allocInts(nb, 0);
+    logTop = allocInts(nb, 0);
+    sp = 0;
+    stack[sp] = 0;
+    phase[sp] = 0;
+    sp++;
+    while (sp > 0) {
+        int b = stack[sp - 1];
+        IrBlock* bb = &f->block[b];
+
+        if (phase[sp - 1] == 0) {
+            phase[sp - 1] = 1;
+            logTop[sp - 1] = undo.n;
+            for (int k = 0; k < bb->ninst; k++) {
+                in = &bb->inst[k];
+                switch (in->op) {
+                case IR_PHI:
+                    listAdd(&undo, in->imm);
+                    listAdd(&undo, cur[in->imm]);
+                    cur[in->imm] = in->dst;
+                    break;
+                case IR_LOADV:
+                    repl[in->dst] = cur[in->imm];
+                    in->op = IR_NOP;
+                    break;
+                case IR_STOREV:
+                    listAdd(&undo, in->imm);
+                    listAdd(&undo, cur[in->imm]);
+                    cur[in->imm] = resolve(repl, in->a);
+                    in->op = IR_NOP;
+                    break;
+                case IR_CALL:
+                    for (int j = 0; j < in->nargs; j++)
+                        in->args[j] = resolve(repl, in->args[j]);
+                    break;
+                default:
+                    in->a = resolve(repl, in->a);
+                    in->b = resolve(repl, in->b);
+                    break;
+                }
+            }
+            bb->value = resolve(repl, bb->value);
+            for (int s = 0; s < bb->nsucc; s++) {
+                IrBlock* sb = &f->block[bb->succ[s]];
+                int j = irPredIndex(sb, b);
+                for (int k = 0; k < sb->ninst && sb->inst[k].op == IR_PHI; k++)
+                    sb->inst[k].args[j] = cur[sb->inst[k].imm];
+            }
+            /* 자식은 이 블록 위에 쌓으므로, 다시 이 블록으로 오면 모두 끝난 것 */
+            for (int k = kids[b].n - 1; k >= 0; k--) {
+                stack[sp] = kids[b].item[k];
+                phase[sp] = 0;
+                sp++;
+            }
+            continue;
+        }
+
+        /* 자식을 모두 마쳤다: 이 블록에서 바꾼 현재 값을 되돌린다 */
+        while (undo.n > logTop[sp - 1]) {
+            int old = undo.item[--undo.n];
+            int var = undo.item[--undo.n];
+            cur[var] = old;
+        }
+        sp--;
+    }
+
+    irCompact(f);
+    f->ssa = TRUE;
+
+    for (int b = 0; b < nb; b++) {
+        free(df[b].item);
+        free(kids[b].item);
+    }
+    for (int v = 0; v < nv; v++)
+        free(defs[v].item);
+    free(df);
+    free(defs);
+    free(kids);
+    free(mark);
+    free(placed);
+    free(work);
+    free(cur);
+    free(repl);
+    free(undo.item);
+    free(stack);
+    free(phase);
+    free(logTop);
+}
+
+/* =================================================== */
+/* 프로그램                                             */
+/* =================================================== */
+
+void buildIr(TreeNode* tree, IrProgram* prog)
+{
+    int n = 0;
+
+    prog->decls = tree;
+    for (TreeNode* t = tree; t != NULL; t = t->sibling)
+        if (t->nodekind == DeclK && t->kind.decl == FunK) n++;
+    prog->func = (IrFunc*)calloc((size_t)(n > 0 ? n : 1), sizeof(IrFunc));
+    if (prog->func == NULL) outOfMemory();
+    prog->nfuncs = 0;
+    for (TreeNode* t = tree; t != NULL; t = t->sibling) {
+        if (t->nodekind != DeclK || t->kind.decl != FunK) continue;
+        lowerFunction(t, &prog->func[prog->nfuncs]);
+        buildSsa(&prog->func[prog->nfuncs]);
+        prog->nfuncs++;
+    }
+}
+
+void freeIr(IrProgram* prog)
+{
+    for (int i = 0; i < prog->nfuncs; i++) {
+        IrFunc* f = &prog->func[i];
+        for (int b = 0; b < f->nblocks; b++) {
+            for (int k = 0; k < f->block[b].ninst; k++)
+                free(f->block[b].inst[k].args);
+            free(f->block[b].inst);
+            free(f->block[b].pred);
+        }
+        free(f->block);
+        free(f->var);
+        free(f->valueVar);
+    }
+    free(prog->func);
+    prog->func = NULL;
+    prog->nfuncs = 0;
+}
+
+/* =================================================== */
+/* 출력 (-dump-ir)                                      */
+/* =================================================== */
+
+static const char* binName(int op)
+{
+    switch ((TokenType)op) {
+    case PLUS:  return "+";
+    case MINUS: return "-";
+    case TIMES: return "*";
+    case OVER:  return "/";
+    case LT:    return "<";
+    case LTE:   return "<=";
+    case GT:    return ">";
+    case GTE:   return ">=";
+    case EQ:    return "==";
+    case NEQ:   return "!=";
+    case MOD:   return "%";
+    case SHL:   return "<<";
+    case SHR:   return ">>";
+    case USHR:  return ">>>";
+    default:    return "?";
+    }
+}
+
+static void printInst(const IrFunc* f, const IrBlock* b, const IrInst* in)
+{
+    fprintf(listing, "    ");
+    if (in->dst >= 0) fprintf(listing, "v%d = ", in->dst);
+    switch (in->op) {
+    case IR_CONST:  fprintf(listing, "%d", in->imm); break;
+    case IR_COPY:   fprintf(listing, "v%d", in->a); break;
+    case IR_BIN:    fprintf(listing, "v%d %s v%d", in->a, binName(in->imm), in->b); break;
+    case IR_PARAM:  fprintf(listing, "param %d", in->imm); break;
+    case IR_LOADV:  fprintf(listing, "%s", atomName(f->var[in->imm].atom)); break;
+    case IR_STOREV: fprintf(listing, "%s = v%d", atomName(f->var[in->imm].atom), in->a); break;
+    case IR_LOADG:  fprintf(listing, "@%s", atomName(in->sym->atom)); break;
+    case IR_STOREG: fprintf(listing, "@%s = v%d", atomName(in->sym->atom), in->a); break;
+    case IR_CALL:
+        fprintf(listing, "call %s(", atomName(in->sym->atom));
+        for (int k = 0; k < in->nargs; k++)
+            fprintf(listing, "%sv%d", k ? ", " : "", in->args[k]);
+        fprintf(listing, ")");
+        break;
+    case IR_PHI:
+        fprintf(listing, "phi");
+        for (int k = 0; k < in->nargs; k++)
+            fprintf(listing, " [B%d: v%d]", b->pred[k], in->args[k]);
+        break;
+    case IR_NOP:    fprintf(listing, "nop"); break;
+    }
+    if (in->dst >= 0 && f->valueVar[in->dst] >= 0)
+        fprintf(listing, "    ; %s", atomName(f->var[f->valueVar[in->dst]].atom));
+    fprintf(listing, "\n");
+}
+
+void printIr(const IrProgram* prog)
+{
+    fprintf(listing, "\nIR:\n");
+    for (int i = 0; i < prog->nfuncs; i++) {
+        const IrFunc* f = &prog->func[i];
+        fprintf(listing, "function %s (%d blocks, %d values)\n",
+                atomName(f->decl->attr.atom), f->nblocks, f->nvalues);
+        for (int bi = 0; bi < f->nblocks; bi++) {
+            const IrBlock* b = &f->block[bi];
+            if (b->rpo < 0) continue;
+            fprintf(listing, "  B%d:", bi);
+            if (b->npred > 0) {
+                fprintf(listing, "  preds");
+                for (int k = 0; k < b->npred; k++) fprintf(listing, " B%d", b->pred[k]);
+            }
+            if (bi != 0) fprintf(listing, "  idom B%d", b->idom);
+            fprintf(listing, "\n");
+            for (int k = 0; k < b->ninst; k++)
+                printInst(f, b, &b->inst[k]);
+            switch (b->term) {
+            case TERM_JMP:
+                fprintf(listing, "    jmp B%d\n", b->succ[0]);
+                break;
+            case TERM_BR:
+                fprintf(listing, "    br v%d ? B%d : B%d\n", b->value, b->succ[0], b->succ[1]);
+                break;
+            case TERM_RET:
+                if (b->value >= 0) fprintf(listing, "    ret v%d\n", b->value);
+                else fprintf(listing, "    ret\n");
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/****************************************************/
+/* File: ir.h                                       */
+/* Three-address SSA IR for the C- compiler         */
+/****************************************************/
+
+#ifndef _IR_H_
+#define _IR_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* 함수마다 기본 블록의 CFG 와, Java 로 goto 없이 되돌리기 위한 구조 트리
+ * (순차 / if / while) 를 둔다. 값은 함수 안에서 0 부터 번호를 매기고,
+ * buildSsa 뒤에는 값마다 정의가 하나다 (합류 지점은 PHI).
+ * 지역 변수(파라미터 포함)는 번호로, 전역 변수와 함수는 심볼 항목으로 가리킨다 */
+
+typedef enum {
+    IR_CONST,    /* dst = imm */
+    IR_COPY,     /* dst = a */
+    IR_BIN,      /* dst = a <imm> b  (imm 은 PLUS ... NEQ) */
+    IR_PARAM,    /* dst = imm 번째 파라미터 (진입 블록에만) */
+    IR_LOADV,    /* dst = 지역 변수 imm   (SSA 전에만) */
+    IR_STOREV,   /* 지역 변수 imm = a     (SSA 전에만) */
+    IR_LOADG,    /* dst = 전역 sym */
+    IR_STOREG,   /* 전역 sym = a */
+    IR_CALL,     /* dst = sym(args...)  (void 함수면 dst 는 -1) */
+    IR_PHI,      /* dst = phi(args[k] : k 번째 선행 블록), imm 은 원래 변수 */
+    IR_NOP       /* 지워진 명령 (irCompact 가 치운다) */
+} IrOp;
+
+typedef struct {
+    IrOp op;
+    int dst;                 /* 정의하는 값 (없으면 -1) */
+    int a, b;                /* 피연산자 값 */
+    int imm;
+    struct BucketList* sym;  /* LOADG / STOREG / CALL */
+    int* args;               /* CALL 인자, PHI 인자 */
+    int nargs;
+    int line;                /* 원래 노드의 줄 */
+} IrInst;
+
+/* 블록 끝 */
+typedef enum {
+    TERM_NONE,   /* 아직 닫지 않음 */
+    TERM_JMP,    /* succ[0] 으로 */
+    TERM_BR,     /* cond != 0 이면 succ[0], 아니면 succ[1] */
+    TERM_RET     /* value 를 돌려준다 (void 면 -1) */
+} IrTermKind;
+
+typedef struct {
+    IrInst* inst;
+    int ninst, cap;
+    IrTermKind term;
+    int value;               /* BR 의 조건, RET 의 값 */
+    int succ[2];
+    int nsucc;
+    int* pred;
+    int npred;
+    int idom;                /* 직접 지배자 (진입 블록과 닿지 않는 블록은 -1) */
+    int rpo;                 /* 역 후위 순서 번호 (닿지 않으면 -1) */
+} IrBlock;
+
+/* 구조 트리 (LOOP 는 꼬리 재귀를 없앤 함수의 몸체: 머리로 가는 간선이 continue) */
+typedef enum { IRS_SEQ, IRS_BLOCK, IRS_IF, IRS_WHILE, IRS_LOOP } IrRegionKind;
+
+typedef struct IrRegion {
+    IrRegionKind kind;
+    int block;               /* BLOCK: 블록, IF: 조건 분기로 끝나는 앞 블록, WHILE / LOOP: 머리 블록 */
+    struct IrRegion* body;   /* SEQ: 첫 항목, IF: then, WHILE / LOOP: 몸체 */
+    struct IrRegion* alt;    /* IF: else */
+    struct IrRegion* next;   /* SEQ 안의 다음 항목 */
+} IrRegion;
+
+typedef struct {
+    int atom;
+    int param;               /* 파라미터 순서 (지역 변수면 -1) */
+} IrVar;
+
+typedef struct {
+    TreeNode* decl;          /* FunK */
+    IrBlock* block;          /* block[0] 이 진입 */
+    int nblocks, blockCap;
+    IrRegion* region;        /* 몸체 (SEQ) */
+    IrVar* var;
+    int nvars, varCap;
+    int* valueVar;           /* 값의 원래 변수 (이름 붙이기용, 임시 값은 -1) */
+    int nvalues, valueCap;
+    int nparams;
+    int ssa;                 /* buildSsa 를 마쳤다 */
+} IrFunc;
+
+typedef struct {
+    TreeNode* decls;         /* 최상위 선언 목록 (전역 변수는 여기서 그대로 본다) */
+    IrFunc* func;            /* 함수 선언 순서 */
+    int nfuncs;
+} IrProgram;
+
+/* 검사를 마친 (오류 없는) 선언 목록을 IR 로 내리고 함수마다 SSA 로 만든다.
+ * 노드의 sym 을 따라가므로 analyze 뒤에 부른다 */
+void buildIr(TreeNode* tree, IrProgram* prog);
+void freeIr(IrProgram* prog);
+
+/* 한 함수: AST → 블록, CFG → 지배자 → 지배 경계 → PHI 삽입 → 이름 바꾸기 */
+void lowerFunction(TreeNode* fun, IrFunc* f);
+void buildCfg(IrFunc* f);
+void irDominators(IrFunc* f);         /* 선행 블록은 그대로 두고 rpo 와 idom 만 다시 */
+void buildSsa(IrFunc* f);
+
+/* 명령 / 값 도우미 (최적화 단계에서도 쓴다) */
+int irNewValue(IrFunc* f, int var);
+int irNewBlock(IrFunc* f);
+IrRegion* irNewRegion(IrRegionKind kind, int block);   /* 현재 아레나에서 */
+IrInst* irAppend(IrFunc* f, int block, IrOp op);
+void irCompact(IrFunc* f);            /* IR_NOP 제거 */
+int irPredIndex(const IrBlock* b, int pred);
+void irRemovePred(IrFunc* f, int block, int pred);   /* 간선 pred → block 과 PHI 인자를 뺀다 */
+/* 바뀐 CFG 를 구조 트리에 반영한다: JMP 로 끝나게 된 if / while 을 풀고 닿지 않는 항목을 뺀다 */
+void irFixRegions(const IrFunc* f, IrRegion* seq);
+
+/* 읽을 수 있는 형태로 출력 (-dump-ir) */
+void printIr(const IrProgram* prog);
+
+#endif
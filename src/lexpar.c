@@ -0,0 +1,206 @@
+/****************************************************/
+/* File: lexpar.c                                   */
+/* Parallel chunked scanner for the C- compiler     */
+/****************************************************/
+
+#include "globals.h"
+#include "scan.h"
+#include "source.h"
+#include "scansimd.h"
+#include "intern.h"
+#include "thread.h"
+#include "lexpar.h"
+
+#define MIN_CHUNK (256 * 1024)  /* 이보다 작은 청크는 나누지 않는다 */
+
+/* 청크가 "주석 안"에서 시작했는지는 앞 청크를 다 봐야 알 수 있다.
+ * 그래서 청크마다 두 경우(주석 밖 / 주석 안)를 모두 스캔해 두고,
+ * 앞에서부터 실제 상태를 따라가며 맞는 쪽 결과를 이어 붙인다 */
+typedef struct {
+    TokenArray tok;    /* line 은 청크 안의 상대 줄, ID 의 val 은 이름 해시 */
+    int endsInComment; /* 청크 끝이 주석 안인가 */
+} ChunkScan;
+
+typedef struct {
+    int begin, end;    /* [begin, end): begin 은 줄의 시작 */
+    int newlines;      /* 청크 안의 '\n' 수 */
+    ChunkScan out;     /* 주석 밖에서 시작한다고 가정 */
+    ChunkScan in;      /* 주석 안에서 시작한다고 가정 (0 번 청크는 안 씀) */
+} Chunk;
+
+static int countNewlines(const char* buf, int from, int to)
+{
+    int n = 0;
+    const char* p = buf + from;
+    const char* end = buf + to;
+
+    while (p < end && (p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+/* buf[from .. to) 는 공백과 주석뿐이다: to 가 주석 안에 있는가 */
+static int gapInComment(const char* buf, int from, int to, int len)
+{
+    int pos = from;
+
+    while (pos < to) {
+        if (buf[pos] == '/' && buf[pos + 1] == '*') {
+            pos = scanKernels.commentEnd(buf, pos + 2, len);
+            if (pos < 0 || pos > to)
+                return TRUE;
+        }
+        else
+            pos++;
+    }
+    return FALSE;
+}
+
+/* 청크 하나를 주어진 시작 상태로 스캔한다.
+ * 청크 안에서 시작하는 토큰만 담고, 다음 청크의 첫 토큰을 만나면 멈춘다 */
+static void scanChunk(const Chunk* c, int startInComment, ChunkScan* cs)
+{
+    const char* buf = source.buf;
+    int len = source.len;
+    ScanState ss;
+    Token t;
+    int pos = c->begin;
+    int lineAt = c->begin, line = 0;  /* lineAt 까지의 상대 줄 번호 */
+
+    cs->tok.tok = NULL;
+    cs->tok.count = 0;
+    cs->tok.cap = 0;
+    cs->endsInComment = FALSE;
+
+    if (startInComment) {
+        pos = scanKernels.commentEnd(buf, pos, len);
+        if (pos < 0 || pos > c->end) {
+            /* 청크 전체가 주석. 마지막 청크면 닫히지 않은 주석이므로 파일 끝을 담는다 */
+            cs->endsInComment = TRUE;
+            if (c->end == len) {
+                t.kind = ENDFILE;
+                t.file = 0;
+                t.line = -1;
+                t.start = len;
+                t.len = 0;
+                t.val = 0;
+                pushToken(&cs->tok, &t);
+            }
+            return;
+        }
+    }
+
+    scanInit(&ss, buf, len);
+    ss.pos = pos;
+    for (;;) {
+        int prevEnd = ss.pos;
+        t.kind = (short)scanNext(&ss);
+        t.file = 0;
+        /* 다음 청크에서 시작하는 토큰 (파일 끝은 마지막 청크만 담는다) */
+        if (t.kind == ENDFILE ? c->end < len : ss.start >= c->end) {
+            cs->endsInComment = gapInComment(buf, prevEnd, c->end, len);
+            break;
+        }
+        if (ss.last >= len)
+            t.line = -1;  /* 파일 끝: 이어 붙일 때 마지막 줄 + 1 */
+        else {
+            line += countNewlines(buf, lineAt, ss.last);
+            lineAt = ss.last;
+            t.line = line;
+        }
+        t.start = ss.start;
+        t.len = ss.pos - ss.start;
+        if (t.kind == NUM)
+            t.val = numberValue(buf + t.start, t.len);
+        else if (t.kind == ID)
+            t.val = (int)internHash(buf + t.start, t.len);
+        else
+            t.val = 0;
+        pushToken(&cs->tok, &t);
+        if (t.kind == ENDFILE)
+            break;
+    }
+}
+
+static void chunkWorker(void* arg, int k)
+{
+    Chunk* c = (Chunk*)arg + k;
+
+    scanChunk(c, FALSE, &c->out);
+    if (k > 0)
+        scanChunk(c, TRUE, &c->in);
+    c->newlines = countNewlines(source.buf, c->begin, c->end);
+}
+
+void lexAllParallel(TokenArray* ta, int nthreads)
+{
+    const char* buf = source.buf;
+    int len = source.len;
+    Chunk* chunks;
+    int n, k, base, inComment, eofLine;
+
+    if (nthreads <= 0)
+        nthreads = cpuCount();
+    n = len / MIN_CHUNK;
+    if (n > nthreads) n = nthreads;
+    /* #include 는 파일 순서대로 펼쳐야 하므로 순차 스캔으로 */
+    if (n <= 1 || memchr(buf, '#', (size_t)len) != NULL) {
+        lexAll(ta);
+        return;
+    }
+
+    chunks = (Chunk*)calloc((size_t)n, sizeof(Chunk));
+    if (chunks == NULL) {
+        fprintf(listing, "Error: Out of memory for scanner chunks\n");
+        exit(1);
+    }
+    /* 경계는 균등 분할 지점 다음의 줄 시작으로 옮긴다 (토큰은 줄을 넘지 않음) */
+    for (k = 0; k < n; k++) {
+        int end = (int)((long long)len * (k + 1) / n);
+        if (k == n - 1)
+            end = len;
+        else {
+            const char* p = (const char*)memchr(buf + end, '\n', (size_t)(len - end));
+            end = p ? (int)(p - buf) + 1 : len;
+        }
+        chunks[k].begin = k ? chunks[k - 1].end : 0;
+        if (end < chunks[k].begin) end = chunks[k].begin;
+        chunks[k].end = end;
+    }
+
+    /* 작업자의 scanInit 이 공유 표를 만들지 않도록 여기서 먼저 */
+    initScanTables();
+    runParallel(n, chunkWorker, chunks);
+
+    /* 앞에서부터 실제 주석 상태에 맞는 결과를 골라 이어 붙인다.
+     * atom 도 여기서 순서대로 등록하므로 순차 스캔과 번호가 같다 */
+    ta->tok = NULL;
+    ta->count = 0;
+    ta->cap = 0;
+    base = 1;
+    inComment = FALSE;
+    eofLine = srcLineCount(&source) + 1;
+    for (k = 0; k < n; k++) {
+        ChunkScan* cs = inComment ? &chunks[k].in : &chunks[k].out;
+        for (int i = 0; i < cs->tok.count; i++) {
+            Token t = cs->tok.tok[i];
+            t.line = (t.line < 0) ? eofLine : base + t.line;
+            if (t.kind == ID)
+                t.val = internNameHashed(buf + t.start, t.len, (unsigned int)t.val);
+            pushToken(ta, &t);
+        }
+        base += chunks[k].newlines;
+        inComment = cs->endsInComment;
+        freeTokens(&chunks[k].out.tok);
+        freeTokens(&chunks[k].in.tok);
+    }
+    free(chunks);
+
+    if (EchoSource || TraceScan) {
+        for (int i = 0; i < ta->count; i++)
+            listToken(&ta->tok[i]);
+    }
+    lineno = ta->count > 0 ? ta->tok[ta->count - 1].line : eofLine;
+}
@@ -0,0 +1,16 @@
+/****************************************************/
+/* File: lexpar.h                                   */
+/* Parallel chunked scanner for the C- compiler     */
+/****************************************************/
+
+#ifndef _LEXPAR_H_
+#define _LEXPAR_H_
+
+#include "scan.h"
+
+/* source 를 줄 경계에서 청크로 나눠 nthreads 개의 스레드로 스캔한다.
+ * 결과 토큰 배열(줄 번호, atom, 에코/트레이스 출력 포함)은 lexAll 과 같다.
+ * nthreads 가 0 이면 모든 코어를 쓴다 */
+void lexAllParallel(TokenArray* ta, int nthreads);
+
+#endif
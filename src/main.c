@@ -10,86 +10,240 @@
 #include "symtab.h"
 #include "semantic.h"
 #include "cgen.h"
-
-int lineno = 0;
-FILE* source;
-FILE* listing;
+#include "source.h"
+#include "bench.h"
+#include "intern.h"
+#include "arena.h"
+#include "flat.h"
+#include "pipeline.h"
+#include "include.h"
+#include "callgraph.h"
+#include "ir.h"
+#include "opt.h"
+
+THREAD_LOCAL int lineno = 0;
+SourceFile source;
+THREAD_LOCAL FILE* listing;
 
 int EchoSource = TRUE;
 int TraceScan = TRUE;
 int TraceParse = TRUE;
-int Error = FALSE;
+THREAD_LOCAL int Error = FALSE;
+
+int LexThreads = 1;
+int ParseThreads = 1;
+int SemThreads = 1;
+int FlatAst = FALSE;
+int Pipelined = FALSE;
+int TokenCache = TRUE;
+int FusedCheck = FALSE;
+
+/* 한 번의 컴파일이 쓰는 AST 노드와 문자열 */
+static Arena compileArena;
+
+static void usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [-bench-scan] [-bench-lex] [-lex-threads N] [-parse-threads N] [-sem-threads N] [-flat] [-pipeline] [-fused] [-no-tokcache] [-symstats] [-callgraph] [-reachable] [-ir] [-dump-ir] [-O0|-O1|-O2] [-f<pass>|-fno-<pass>] [-pass-stats] <filename>\n", prog);
+    exit(1);
+}
 
 int main(int argc, char* argv[])
 {
     TreeNode* syntaxTree;
+    FlatTree flatTree;
     char pgm[120];
-
-    /* 프로그램 실행 인자 체크 */
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s <filename>\n", argv[0]);
-        exit(1);
+    char codefile[130];
+    char* dot;
+    char* fname = NULL;
+    int benchScan = FALSE;
+    int benchLex = FALSE;
+    int symStats = FALSE;
+    int showCallGraph = FALSE;
+    int reachableOnly = FALSE;
+    int useIr = FALSE;
+    int dumpIr = FALSE;
+    int passStats = FALSE;
+    IrProgram ir;
+
+    /* 프로그램 실행 인자 체크: [옵션] <filename> */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-bench-scan") == 0)
+            benchScan = TRUE;
+        else if (strcmp(argv[i], "-bench-lex") == 0)
+            benchLex = TRUE;
+        else if (strcmp(argv[i], "-flat") == 0)
+            FlatAst = TRUE;
+        else if (strcmp(argv[i], "-pipeline") == 0)
+            Pipelined = TRUE;
+        else if (strcmp(argv[i], "-fused") == 0)
+            FusedCheck = TRUE;
+        else if (strcmp(argv[i], "-no-tokcache") == 0)
+            TokenCache = FALSE;
+        else if (strcmp(argv[i], "-symstats") == 0)
+            symStats = TRUE;
+        else if (strcmp(argv[i], "-callgraph") == 0)
+            showCallGraph = TRUE;
+        else if (strcmp(argv[i], "-reachable") == 0)
+            reachableOnly = TRUE;
+        else if (strcmp(argv[i], "-ir") == 0)
+            useIr = TRUE;
+        else if (strcmp(argv[i], "-dump-ir") == 0)
+            dumpIr = TRUE;
+        else if (strcmp(argv[i], "-pass-stats") == 0)
+            passStats = TRUE;
+        else if (optParseFlag(argv[i]))
+            continue;
+        else if (strcmp(argv[i], "-lex-threads") == 0 && i + 1 < argc)
+            LexThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-parse-threads") == 0 && i + 1 < argc)
+            ParseThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-sem-threads") == 0 && i + 1 < argc)
+            SemThreads = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && fname == NULL)
+            fname = argv[i];
+        else
+            usage(argv[0]);
     }
+    if (fname == NULL)
+        usage(argv[0]);
 
     /* 소스 파일 이름 처리 */
-    strcpy(pgm, argv[1]);
+    strcpy(pgm, fname);
     if (strchr(pgm, '.') == NULL)
         strcat(pgm, ".c");
 
-    /* 소스 파일 열기 */
-    source = fopen(pgm, "r");
-    if (source == NULL) {
+    /* 소스 파일 열기 (전체를 메모리에 매핑) */
+    if (!openSource(&source, pgm)) {
         fprintf(stderr, "File %s not found\n", pgm);
         exit(1);
     }
 
     listing = stdout;
+
+    /* #include "파일" 은 소스 파일의 디렉터리에서 찾는다 */
+    includeInit(pgm);
+
+    /* 벤치마크 모드: 컴파일 대신 처리량만 측정 */
+    if (benchScan || benchLex) {
+        if (benchScan) benchScanner(pgm, 16);
+        if (benchLex) benchLexer(pgm, 64);
+        closeSource(&source);
+        return 0;
+    }
+
     fprintf(listing, "\nC-Minus COMPILER START: %s\n", pgm);
 
-    /* 심볼 테이블 초기화 */
+    /* 이름표(atom)와 심볼 테이블, 노드 arena 초기화 */
+    initIntern();
     initSymTab();
+    arenaInit(&compileArena, ARENA_BLOCK);
+    curArena = &compileArena;
+
+    /* 출력 파일명 생성: example.c → example_out.java */
+    dot = strrchr(fname, '.');
+    if (dot != NULL) {
+        size_t len = dot - fname;
+        strncpy(codefile, fname, len);
+        codefile[len] = '\0';
+    }
+    else {
+        strcpy(codefile, fname);
+    }
 
-    /* 1. 구문 분석 (Parsing) */
+    strcat(codefile, "_out.java");  // ← JAVA 파일 생성
+
+    /* -ir: 코드 생성은 IR 에서 (트리를 펼 필요가 없다). IR 최적화 단계가 켜져도 마찬가지 */
+    ir.nfuncs = 0;
+    ir.func = NULL;
+    if (optWantsIr()) useIr = TRUE;
+    if (useIr || dumpIr) FlatAst = FALSE;
+
+    /* -pipeline: 네 단계를 스레드로 겹쳐 실행 (출력은 아래 순차 흐름과 같음) */
+    if (Pipelined) {
+        FusedCheck = FALSE;
+        syntaxTree = compilePipelined(codefile);
+        flatTree.count = 0;
+        FlatAst = FALSE;
+        goto done;
+    }
+
+    /* 1. 구문 분석 (Parsing), -fused 면 의미 분석도 함께 */
+    if (FusedCheck && !fusedBegin())
+        FusedCheck = FALSE;
     syntaxTree = parse();
 
     /* 2. 의미 분석 (Semantic Analysis) */
-    if (syntaxTree != NULL && (Error == FALSE)) {
+    if (FusedCheck) {
+        fusedFinish(syntaxTree != NULL && (Error == FALSE));
+    }
+    else if (syntaxTree != NULL && (Error == FALSE)) {
         analyze(syntaxTree);
     }
 
+    /* -callgraph / -reachable: 호출 그래프. 검사는 모두 끝났고,
+     * -reachable 이면 main 에서 닿지 않는 선언은 출력과 코드 생성에서 뺀다 */
+    if (syntaxTree != NULL && Error == FALSE && (showCallGraph || reachableOnly)) {
+        CallGraph cg;
+        buildCallGraph(syntaxTree, &cg);
+        if (showCallGraph) printCallGraph(&cg);
+        if (reachableOnly) syntaxTree = pruneUnreachable(&cg);
+        freeCallGraph(&cg);
+    }
+
+    /* -O / -f<단계>: 트리 단계, IR 을 만든 뒤 IR 단계 */
+    if (syntaxTree != NULL && Error == FALSE)
+        syntaxTree = runAstPasses(syntaxTree);
+
+    /* -ir / -dump-ir: 함수마다 3-주소 IR 의 CFG 를 SSA 로 */
+    if (syntaxTree != NULL && Error == FALSE && (useIr || dumpIr)) {
+        buildIr(syntaxTree, &ir);
+        runIrPasses(&ir);
+    }
+
+    /* -flat: 이후 단계는 전위 순서 배열에서 진행 (포인터 트리는 버린다) */
+    flatTree.count = 0;
+    if (FlatAst) {
+        flattenTree(syntaxTree, &flatTree);
+        arenaReset(&compileArena);
+        syntaxTree = NULL;
+    }
+
     /* 3. AST 출력 */
     if (TraceParse && (Error == FALSE)) {
         fprintf(listing, "\nSyntax tree:\n");
-        printTree(syntaxTree);
+        if (FlatAst) printFlatTree(&flatTree);
+        else printTree(syntaxTree);
     }
+    if (dumpIr && Error == FALSE)
+        printIr(&ir);
 
     /* 4. 코드 생성 (오류 없는 경우 실행) */
     if (Error == FALSE) {
-        char codefile[130];
-
-        /* 출력 파일명 생성: example.c → example_out.java */
-        char* dot = strrchr(argv[1], '.');
-        if (dot != NULL) {
-            size_t len = dot - argv[1];
-            strncpy(codefile, argv[1], len);
-            codefile[len] = '\0';
-        }
-        else {
-            strcpy(codefile, argv[1]);
-        }
-
-        strcat(codefile, "_out.java");  // ← JAVA 파일 생성
-
         /* 코드 생성기 실행 */
-        codeGen(syntaxTree, codefile);
+        if (FlatAst) codeGenFlat(&flatTree, codefile);
+        else if (useIr) codeGenIr(&ir, codefile);
+        else codeGen(syntaxTree, codefile);
     }
 
+done:
+    /* -symstats: 심볼 테이블의 탐사 거리와 조회 수 */
+    if (symStats)
+        st_stats(listing);
+
+    /* -pass-stats: 최적화 단계별 시간과 바꾼 수 */
+    if (passStats)
+        printPassStats(listing);
+
     /* 결과 메시지 */
     if (Error)
         fprintf(listing, "\nCompilation finished with errors.\n");
     else
         fprintf(listing, "\nCompilation finished successfully.\n");
 
-    fclose(source);
+    /* 트리와 문자열은 arena 와 함께 한 번에 해제 */
+    arenaFree(&compileArena);
+    if (FlatAst) freeFlatTree(&flatTree);
+    freeIr(&ir);
+    closeSource(&source);
     return 0;
 }
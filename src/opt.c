@@ -0,0 +1,223 @@
+/****************************************************/
+/* File: opt.c                                      */
+/* Optimization pass manager for the C- compiler    */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "opt.h"
+#include "fold.h"
+#include "rewrite.h"
+#include "tailrec.h"
+
+#define MAX_ROUNDS 4   /* -O2 에서 IR 단계를 되풀이하는 최대 바퀴 */
+
+typedef enum { PASS_AST, PASS_IR } PassLevel;
+
+typedef struct {
+    const char* name;                  /* -f<name> / -fno-<name> */
+    PassLevel level;
+    int minLevel;                      /* 이 -O 부터 켜진다 */
+    TreeNode* (*runAst)(TreeNode* tree, long* changed);
+    long (*runIr)(IrFunc* f);
+    int force;                         /* -f 면 1, -fno- 면 0, 안 주면 -1 */
+    int runs;
+    long changed;
+    double seconds;
+} Pass;
+
+static long deadCode(IrFunc* f);
+
+/* 실행 순서대로 */
+static Pass passes[] = {
+    { "fold",      PASS_AST, 1, foldConstants, NULL, -1, 0, 0, 0.0 },
+    { "rewrite",   PASS_AST, 1, rewriteTrees, NULL, -1, 0, 0, 0.0 },
+    { "constprop", PASS_IR,  1, NULL, propagateConstants, -1, 0, 0, 0.0 },
+    { "tailrec",   PASS_IR,  2, NULL, eliminateTailCalls, -1, 0, 0, 0.0 },
+    { "dce",       PASS_IR,  1, NULL, deadCode, -1, 0, 0, 0.0 },
+};
+
+#define NPASSES ((int)(sizeof(passes) / sizeof(passes[0])))
+
+static int optLevel = 0;
+
+int optParseFlag(const char* arg)
+{
+    const char* name;
+    int on = TRUE;
+
+    if (arg[0] != '-') return FALSE;
+    if (arg[1] == 'O' && arg[2] >= '0' && arg[2] <= '2' && arg[3] == '\0') {
+        optLevel = arg[2] - '0';
+        return TRUE;
+    }
+    if (arg[1] != 'f') return FALSE;
+    name = arg + 2;
+    if (strncmp(name, "no-", 3) == 0) {
+        name += 3;
+        on = FALSE;
+    }
+    for (int i = 0; i < NPASSES; i++) {
+        if (strcmp(passes[i].name, name) == 0) {
+            passes[i].force = on;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static int enabled(const Pass* p)
+{
+    return p->force >= 0 ? p->force : optLevel >= p->minLevel;
+}
+
+int optWantsIr(void)
+{
+    for (int i = 0; i < NPASSES; i++)
+        if (passes[i].level == PASS_IR && enabled(&passes[i])) return TRUE;
+    return FALSE;
+}
+
+TreeNode* runAstPasses(TreeNode* tree)
+{
+    for (int i = 0; i < NPASSES; i++) {
+        Pass* p = &passes[i];
+        double start;
+        long changed = 0;
+
+        if (p->level != PASS_AST || !enabled(p)) continue;
+        start = wallClock();
+        tree = p->runAst(tree, &changed);
+        p->seconds += wallClock() - start;
+        p->changed += changed;
+        p->runs++;
+    }
+    return tree;
+}
+
+void runIrPasses(IrProgram* prog)
+{
+    int rounds = optLevel >= 2 ? MAX_ROUNDS : 1;
+
+    for (int r = 0; r < rounds; r++) {
+        long round = 0;
+        for (int i = 0; i < NPASSES; i++) {
+            Pass* p = &passes[i];
+            double start;
+            long changed = 0;
+
+            if (p->level != PASS_IR || !enabled(p)) continue;
+            start = wallClock();
+            for (int k = 0; k < prog->nfuncs; k++)
+                changed += p->runIr(&prog->func[k]);
+            p->seconds += wallClock() - start;
+            p->changed += changed;
+            p->runs++;
+            round += changed;
+        }
+        if (round == 0) break;
+    }
+}
+
+void printPassStats(FILE* out)
+{
+    fprintf(out, "\nOptimization passes (-O%d):\n", optLevel);
+    fprintf(out, "  %-12s %-4s %5s %10s %10s\n", "pass", "on", "runs", "changed", "ms");
+    for (int i = 0; i < NPASSES; i++) {
+        const Pass* p = &passes[i];
+        fprintf(out, "  %-12s %-4s %5d %10ld %10.3f\n", p->name,
+                enabled(p) ? (p->level == PASS_AST ? "ast" : "ir") : "-",
+                p->runs, p->changed, p->seconds * 1000.0);
+    }
+}
+
+/* =================================================== */
+/* dce: 쓰이지 않는 값 지우기                            */
+/* =================================================== */
+
+/* 지우면 동작이 달라지는 명령: 전역 쓰기, 호출, 0 일 수 있는 수로 나누기 / 나머지 */
+static int hasEffect(const IrInst* in, const IrInst** def)
+{
+    switch (in->op) {
+    case IR_STOREG:
+    case IR_CALL:
+        return TRUE;
+    case IR_BIN:
+        if (in->imm != OVER && in->imm != MOD) return FALSE;
+        return def[in->b] == NULL || def[in->b]->op != IR_CONST || def[in->b]->imm == 0;
+    default:
+        return FALSE;
+    }
+}
+
+static void markValue(int v, char* live, int* work, int* nwork)
+{
+    if (v >= 0 && !live[v]) {
+        live[v] = TRUE;
+        work[(*nwork)++] = v;
+    }
+}
+
+/* 효과 있는 명령과 블록 끝에서 출발해 피연산자를 따라 표시하고, 표시 안 된 값은 지운다.
+ * 서로만 쓰는 PHI 고리도 지워진다 */
+static long deadCode(IrFunc* f)
+{
+    int n = f->nvalues > 0 ? f->nvalues : 1;
+    const IrInst** def = (const IrInst**)calloc((size_t)n, sizeof(IrInst*));
+    char* live = (char*)calloc((size_t)n, 1);
+    int* work = (int*)malloc(sizeof(int) * (size_t)n);
+    int nwork = 0;
+    long removed = 0;
+
+    if (def == NULL || live == NULL || work == NULL) {
+        fprintf(stderr, "Error: Out of memory in optimizer\n");
+        exit(1);
+    }
+
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++)
+            if (b->inst[k].dst >= 0) def[b->inst[k].dst] = &b->inst[k];
+    }
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        if (b->rpo < 0) continue;
+        for (int k = 0; k < b->ninst; k++) {
+            const IrInst* in = &b->inst[k];
+            if (!hasEffect(in, def)) continue;
+            /* 값이 없는 명령도 있으니 피연산자를 바로 표시 (값이 있으면 그 값도 산다) */
+            markValue(in->a, live, work, &nwork);
+            markValue(in->b, live, work, &nwork);
+            for (int j = 0; j < in->nargs; j++) markValue(in->args[j], live, work, &nwork);
+            markValue(in->dst, live, work, &nwork);
+        }
+        if (b->term == TERM_BR || b->term == TERM_RET)
+            markValue(b->value, live, work, &nwork);
+    }
+
+    while (nwork > 0) {
+        const IrInst* in = def[work[--nwork]];
+        if (in == NULL) continue;
+        markValue(in->a, live, work, &nwork);
+        markValue(in->b, live, work, &nwork);
+        if (in->op == IR_CALL || in->op == IR_PHI)
+            for (int j = 0; j < in->nargs; j++) markValue(in->args[j], live, work, &nwork);
+    }
+
+    /* 파라미터는 Java 머리에 그대로 남으므로 건드리지 않는다 */
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            IrInst* in = &b->inst[k];
+            if (in->dst < 0 || live[in->dst] || in->op == IR_PARAM || in->op == IR_NOP) continue;
+            in->op = IR_NOP;
+            removed++;
+        }
+    }
+    if (removed > 0) irCompact(f);
+
+    free(def);
+    free(live);
+    free(work);
+    return removed;
+}
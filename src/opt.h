@@ -0,0 +1,32 @@
+/****************************************************/
+/* File: opt.h                                      */
+/* Optimization pass manager for the C- compiler    */
+/****************************************************/
+
+#ifndef _OPT_H_
+#define _OPT_H_
+
+#include "globals.h"
+#include "parse.h"
+#include "ir.h"
+
+/* 최적화 단계는 opt.c 의 표에 순서대로 등록한다.
+ * 트리 단계는 의미 분석 뒤 IR 을 만들기 전에, IR 단계는 SSA 를 만든 뒤 함수마다 돈다.
+ * 단계는 바꾼 노드(명령) 수를 돌려주고, 관리자는 단계별 시간과 합계를 모은다 */
+
+/* -O0 / -O1 / -O2 / -f<단계> / -fno-<단계> 이면 받아들이고 TRUE */
+int optParseFlag(const char* arg);
+
+/* 켜진 IR 단계가 있다 (있으면 코드 생성도 IR 에서) */
+int optWantsIr(void);
+
+/* 켜진 트리 단계를 차례로: 선언 목록의 머리를 돌려준다 */
+TreeNode* runAstPasses(TreeNode* tree);
+
+/* 켜진 IR 단계를 차례로 (-O2 는 바뀌는 것이 없을 때까지 몇 바퀴) */
+void runIrPasses(IrProgram* prog);
+
+/* 단계별 실행 횟수, 바꾼 수, 시간 (-pass-stats) */
+void printPassStats(FILE* out);
+
+#endif
@@ -6,9 +6,29 @@
 #include "globals.h"
 #include "util.h"
 #include "scan.h"
+#include "lexpar.h"
+#include "include.h"
 #include "parse.h"
+#include "arena.h"
+#include "thread.h"
+#include "semantic.h"
 
-static TokenType token; /* 현재 토큰을 저장 */
+/* 토큰 배열은 모든 스레드가 같이 읽고, 읽는 위치는 스레드마다 따로 */
+static THREAD_LOCAL TokenType token; /* 현재 토큰을 저장 */
+static TokenArray tokens; /* 선행 패스에서 읽어 둔 전체 토큰 */
+static THREAD_LOCAL int tokpos;        /* 현재 토큰의 인덱스 */
+
+#define curTok  (tokens.tok[tokpos])
+#define curText tokText(&curTok)
+
+/* -fused: 노드를 만들면서 의미 분석 (semantic.h). 전위 동작(선언 등록, 스코프 진입)은
+ * 노드를 만들 때, 후위 동작(타입 검사, 스코프 탈출)은 자식까지 다 만든 뒤에 한다.
+ * 구문 오류(Error)가 난 뒤에는 어차피 분석 결과를 버리므로 부르지 않는다 */
+#define SEM_ENTER(t) do { if (FusedCheck && !Error) semEnter(t); } while (0)
+#define SEM_LEAVE(t) do { if (FusedCheck && !Error && (t) != NULL) semLeave(t); } while (0)
+
+/* 파이프라인: 스캐너 스레드에서 토큰 블록을 받는 큐 (ENDFILE 까지 받으면 NULL) */
+static SpscQueue* tokenFeed = NULL;
 
 /* -------------------------------------------------- */
 /* 모든 파싱 함수에 대한 선언(forward declaration) */
@@ -29,27 +49,51 @@ static TreeNode* parse_expression_stmt(void);
 static TreeNode* parse_selection_stmt(void);
 static TreeNode* parse_iteration_stmt(void);
 static TreeNode* parse_return_stmt(void);
-static TreeNode* parse_expression(void);
-// static TreeNode * parse_var(void); // parse_factor에 통합됨
-static TreeNode* parse_simple_expression(void);
-static TreeNode* parse_additive_expression(void);
-static TreeNode* parse_term(void);
-static TreeNode* parse_factor(void);
-// static TreeNode * parse_call(void); // parse_factor에 통합됨
-static TreeNode* parse_args(void);
-static TreeNode* parse_arg_list(void);
+static TreeNode* parse_expression(void); // 식 전체 (우선순위 표 기반, 비재귀)
+
+
+/* i 번 토큰까지 받아 둔다 (파이프라인이 아니면 이미 모두 있다) */
+static void needTokens(int i) {
+    while (tokenFeed != NULL && i >= tokens.count) {
+        TokenBlock* b = (TokenBlock*)queuePop(tokenFeed);
+        for (int k = 0; k < b->count; k++)
+            pushToken(&tokens, &b->tok[k]);
+        if (b->tok[b->count - 1].kind == ENDFILE)
+            tokenFeed = NULL;
+        free(b);
+    }
+}
 
+/* 다음 토큰으로 이동 (ENDFILE 에서는 멈춤) */
+static void advance(void) {
+    if (tokpos + 1 >= tokens.count)
+        needTokens(tokpos + 1);
+    if (tokpos < tokens.count - 1)
+        tokpos++;
+    token = (TokenType)curTok.kind;
+    lineno = curTok.line;
+}
+
+/* k 개 뒤의 토큰 종류 (임의 길이 미리보기) */
+static TokenType peek(int k) {
+    int i = tokpos + k;
+    if (i >= tokens.count) {
+        needTokens(i);
+        if (i >= tokens.count) i = tokens.count - 1;
+    }
+    return (TokenType)tokens.tok[i].kind;
+}
 
 /* * 헬퍼 함수: 토큰이 일치하는지 확인하고 다음 토큰을 가져옴
  */
 static void match(TokenType expected) {
     if (token == expected) {
-        token = getToken();
+        advance();
     }
     else {
         // syntax error 처리 
         fprintf(listing, "Syntax error: unexpected token -> ");
-        printToken(token, tokenString);
+        printToken(token, curText, curTok.len);
         Error = TRUE; // 에러 플래그 설정
     }
 }
@@ -93,7 +137,7 @@ static TreeNode* parse_declaration_list(void) {
 static TreeNode* parse_declaration(void) {
     TreeNode* t = NULL;
     ExpType type;
-    char* name;
+    int name;
 
     // 1. type-specifier 파싱
     if (token == INT) type = Integer;
@@ -106,29 +150,33 @@ static TreeNode* parse_declaration(void) {
         fprintf(listing, "Syntax error: ID expected\n");
         return NULL;
     }
-    name = copyString(tokenString); // ID 이름 복사
+    name = curTok.val; // ID 이름 (atom)
     match(ID);
 
     // 3. '(' 이면 함수 선언, 아니면 변수 선언
     if (token == LPAREN) { // fun-declaration
         t = newDeclNode(FunK);
-        t->attr.name = name;
+        t->attr.atom = name;
         t->type = type;
+        SEM_ENTER(t);
         match(LPAREN);
         t->child[0] = parse_params();
         match(RPAREN);
         t->child[1] = parse_compound_stmt();
+        SEM_LEAVE(t);
     }
     else if (token == SEMI) { // var-declaration
         t = newDeclNode(VarK);
-        t->attr.name = name;
+        t->attr.atom = name;
         t->type = type;
+        SEM_ENTER(t);
+        SEM_LEAVE(t);
         match(SEMI);
     }
     // (배열 [ ] 관련 코드는 에 따라 제외)
     else {
         fprintf(listing, "Syntax error: unexpected token -> ");
-        printToken(token, tokenString);
+        printToken(token, curText, curTok.len);
     }
 
     return t;
@@ -147,7 +195,7 @@ static TreeNode* parse_var_declaration(void) {
     match(token);
 
     if (token == ID) {
-        t->attr.name = copyString(tokenString);
+        t->attr.atom = curTok.val;
         match(ID);
     }
     else {
@@ -155,6 +203,8 @@ static TreeNode* parse_var_declaration(void) {
         return NULL;
     }
 
+    SEM_ENTER(t);
+    SEM_LEAVE(t);
     match(SEMI);
     return t;
 }
@@ -209,7 +259,7 @@ static TreeNode* parse_param(void) {
     }
 
     if (token == ID) {
-        t->attr.name = copyString(tokenString);
+        t->attr.atom = curTok.val;
         match(ID);
     }
     else {
@@ -217,6 +267,8 @@ static TreeNode* parse_param(void) {
     }
 
     // (배열 [ ] 관련 코드는 에 따라 제외)
+    SEM_ENTER(t);
+    SEM_LEAVE(t);
     return t;
 }
 
@@ -225,10 +277,12 @@ static TreeNode* parse_param(void) {
  */
 static TreeNode* parse_compound_stmt(void) {
     TreeNode* t = newStmtNode(CmpdK);
+    SEM_ENTER(t);
     match(LBRACE);
     t->child[0] = parse_local_declarations();
     t->child[1] = parse_statement_list();
     match(RBRACE);
+    SEM_LEAVE(t);
     return t;
 }
 
@@ -305,8 +359,8 @@ static TreeNode* parse_statement(void) {
         break;
     default:
         fprintf(listing, "Syntax error: unexpected token -> ");
-        printToken(token, tokenString);
-        token = getToken(); // 에러 복구 (토큰 하나 버림)
+        printToken(token, curText, curTok.len);
+        advance(); // 에러 복구 (토큰 하나 버림)
         break;
     }
     return t;
@@ -343,6 +397,7 @@ static TreeNode* parse_selection_stmt(void) {
         match(ELSE);
         t->child[2] = parse_statement(); // 'else'
     }
+    SEM_LEAVE(t);
     return t;
 }
 
@@ -356,6 +411,7 @@ static TreeNode* parse_iteration_stmt(void) {
     t->child[0] = parse_expression();
     match(RPAREN);
     t->child[1] = parse_statement();
+    SEM_LEAVE(t);
     return t;
 }
 
@@ -373,169 +429,464 @@ static TreeNode* parse_return_stmt(void) {
         t->child[0] = parse_expression();
         match(SEMI);
     }
+    SEM_LEAVE(t);
     return t;
 }
 
 /*
  * expression -> var = expression | simple-expression
- * (var -> ID )
- * (ID = ... 인지 ID ( ... ) 인지 ID + ... 인지 구분)
+ * simple-expression -> additive-expression [ relop additive-expression ]
+ * additive-expression -> term { addop term }
+ * term -> factor { mulop factor }
+ * factor -> ( expression ) | var | call | NUM
+ * call -> ID ( args ),  args -> [ expression { , expression } ]
+ *
+ * 재귀 대신 연산자 우선순위 표와 명시적 스택으로 파싱한다 (precedence climbing).
+ * 괄호와 호출 인자는 스택에 "프레임"을 하나 쌓아 처리하므로 C 스택 깊이는
+ * 식의 중첩 깊이와 상관없이 일정하다. 만들어지는 트리, 노드의 줄 번호,
+ * 오류 메시지와 복구는 재귀 하강 버전과 같다
  */
-static TreeNode* parse_expression(void) {
-    TreeNode* t = parse_simple_expression();
-
-    // '=' (ASSIGN)는 우선순위가 가장 낮음
-    if (token == ASSIGN) {
-        // 좌변(L-value)이 ID(변수)인지 확인
-        if (t != NULL && t->nodekind == ExpK && t->kind.exp == IdK) {
-            TreeNode* p = newExpNode(OpK);
-            p->attr.op = ASSIGN;
-            p->child[0] = t; // 좌변
-            match(ASSIGN);
-            p->child[1] = parse_expression(); // 우변
-            return p;
-        }
-        else {
-            fprintf(listing, "Syntax error: assignment to non-variable\n");
-        }
-    }
-    return t; // 할당문이 아니면 simple-expression 반환
+
+/* 이항 연산자 우선순위 (0: 이항 연산자 아님). '=' 은 프레임에서 따로 처리 */
+static const unsigned char binPrec[RBRACKET + 1] = {
+    [LT] = 1, [LTE] = 1, [GT] = 1, [GTE] = 1, [EQ] = 1, [NEQ] = 1,
+    [PLUS] = 2, [MINUS] = 2,
+    [TIMES] = 3, [OVER] = 3
+};
+#define PREC_REL 1
+
+/* 식 하나(괄호 안, 인자 하나 포함)의 파싱 상태 */
+typedef enum { FR_TOP, FR_PAREN, FR_ARG } FrameKind;
+
+typedef struct {
+    FrameKind kind;
+    int opBase;          /* 이 프레임이 쓰는 ops[] / opnd[] 의 시작 */
+    int opndBase;
+    int relSeen;         /* 비교 연산자는 결합하지 않으므로 한 번만 */
+    TreeNode* asgHead;   /* var = var = ... 의 대입 사슬 (우결합) */
+    TreeNode* asgTail;
+    TreeNode* call;      /* FR_ARG: 인자를 모으는 호출 노드 */
+    TreeNode* argTail;
+} ExprFrame;
+
+/* 스택들은 파싱 사이에 재사용한다 (스레드마다 따로) */
+static THREAD_LOCAL TreeNode** ops = NULL;     /* 아직 자식을 받지 않은 연산 노드 */
+static THREAD_LOCAL TreeNode** opnd = NULL;    /* 피연산자 */
+static THREAD_LOCAL ExprFrame* frames = NULL;
+static THREAD_LOCAL int opsTop, opndTop, frameTop;
+static THREAD_LOCAL int opsCap = 0, opndCap = 0, frameCap = 0;
+
+static void freeExprStacks(void) {
+    free(ops);
+    free(opnd);
+    free(frames);
+    ops = opnd = NULL;
+    frames = NULL;
+    opsCap = opndCap = frameCap = 0;
 }
 
-/*
- * simple-expression -> additive-expression
- * | additive-expression relop additive-expression
- */
-static TreeNode* parse_simple_expression(void) {
-    TreeNode* t = parse_additive_expression();
-    if (token == LT || token == LTE || token == GT || token == GTE || token == EQ || token == NEQ) {
-        TreeNode* p = newExpNode(OpK);
-        p->attr.op = token; // <, <=, >, >=, ==, !=
-        p->child[0] = t;
-        match(token);
-        p->child[1] = parse_additive_expression();
-        return p;
+static void* growStack(void* p, int* cap, size_t elem) {
+    int n = *cap ? *cap * 2 : 256;
+    p = realloc(p, elem * n);
+    if (p == NULL) {
+        fprintf(listing, "Error: Out of memory in expression parser\n");
+        exit(1);
     }
-    return t;
+    *cap = n;
+    return p;
 }
 
-/*
- * additive-expression -> term { addop term }
- * (좌순환을 루프로 변경, 좌결합)
- */
-static TreeNode* parse_additive_expression(void) {
-    TreeNode* t = parse_term(); // 첫 번째 term
-    while (token == PLUS || token == MINUS) {
-        TreeNode* p = newExpNode(OpK);
-        p->attr.op = token; // + 또는 -
-        p->child[0] = t; // t는 이전까지의 누적 결과
-        match(token);
-        p->child[1] = parse_term();
-        t = p; // t를 새 연산 노드로 업데이트 (좌결합)
+static void pushOpnd(TreeNode* t) {
+    if (opndTop == opndCap) opnd = (TreeNode**)growStack(opnd, &opndCap, sizeof(TreeNode*));
+    opnd[opndTop++] = t;
+}
+
+static void pushOp(TreeNode* t) {
+    if (opsTop == opsCap) ops = (TreeNode**)growStack(ops, &opsCap, sizeof(TreeNode*));
+    ops[opsTop++] = t;
+}
+
+static ExprFrame* pushFrame(FrameKind kind) {
+    ExprFrame* f;
+    if (frameTop == frameCap) frames = (ExprFrame*)growStack(frames, &frameCap, sizeof(ExprFrame));
+    f = &frames[frameTop++];
+    f->kind = kind;
+    f->opBase = opsTop;
+    f->opndBase = opndTop;
+    f->relSeen = FALSE;
+    f->asgHead = f->asgTail = NULL;
+    f->call = f->argTail = NULL;
+    return f;
+}
+
+/* 현재 프레임에서 우선순위가 prec 이상인 연산자들을 트리로 묶는다 (좌결합) */
+static void reduceOps(const ExprFrame* f, int prec) {
+    while (opsTop > f->opBase && binPrec[ops[opsTop - 1]->attr.op] >= prec) {
+        TreeNode* p = ops[--opsTop];
+        p->child[1] = opnd[--opndTop];
+        p->child[0] = opnd[opndTop - 1];
+        opnd[opndTop - 1] = p;
+        SEM_LEAVE(p);
     }
-    return t;
 }
 
-/*
- * term -> factor { mulop factor }
- * (좌순환을 루프로 변경, 좌결합)
- */
-static TreeNode* parse_term(void) {
-    TreeNode* t = parse_factor(); // 첫 번째 factor
-    while (token == TIMES || token == OVER) {
-        TreeNode* p = newExpNode(OpK);
-        p->attr.op = token; // * 또는 /
-        p->child[0] = t;
-        match(token);
-        p->child[1] = parse_factor();
-        t = p; // t를 새 연산 노드로 업데이트 (좌결합)
+/* 프레임을 끝내고 결과 식을 돌려준다 */
+static TreeNode* closeFrame(ExprFrame* f) {
+    TreeNode* t;
+    reduceOps(f, 0);
+    t = opnd[--opndTop];
+    if (f->asgTail != NULL) {
+        f->asgTail->child[1] = t;
+        t = f->asgHead;
+        if (FusedCheck && !Error) {
+            /* 대입 사슬은 안쪽(꼬리)부터: 바깥쪽 노드들을 잠시 피연산자 스택에 */
+            int top = opndTop;
+            for (TreeNode* p = t; p != f->asgTail; p = p->child[1])
+                pushOpnd(p);
+            SEM_LEAVE(f->asgTail);
+            while (opndTop > top) {
+                TreeNode* p = opnd[--opndTop];
+                SEM_LEAVE(p);
+            }
+        }
     }
     return t;
 }
 
-/*
- * factor -> ( expression ) | var | call | NUM
- * var -> ID  (배열 제외 )
- * call -> ID ( args )
- */
-static TreeNode* parse_factor(void) {
-    TreeNode* t = NULL;
-    switch (token) {
-    case NUM:
-        t = newExpNode(ConstK);
-        t->attr.val = atoi(tokenString);
-        match(NUM);
+static TreeNode* parse_expression(void) {
+    ExprFrame* f;
+    TreeNode* t;
+    int base = frameTop;   /* 이 호출의 최상위 프레임 위치 */
+
+    f = pushFrame(FR_TOP);
+    for (;;) {
+        /* 1. 피연산자 (factor) */
+        switch (token) {
+        case NUM:
+            t = newExpNode(ConstK);
+            t->attr.val = curTok.val;
+            match(NUM);
+            SEM_LEAVE(t);
+            pushOpnd(t);
+            break;
+        case ID:
+        {
+            int name = curTok.val;
+            int isCall = (peek(1) == LPAREN); // ID 다음 토큰으로 호출/변수 구분
+            match(ID);
+            if (isCall) { // call: 인자가 있으면 인자 프레임으로
+                t = newExpNode(CallK);
+                t->attr.atom = name;
+                match(LPAREN);
+                if (token != RPAREN) {
+                    f = pushFrame(FR_ARG);
+                    f->call = t;
+                    continue;
+                }
+                match(RPAREN);
+            }
+            else { // var
+                t = newExpNode(IdK);
+                t->attr.atom = name;
+            }
+            SEM_LEAVE(t);
+            pushOpnd(t);
+        }
         break;
-    case ID:
-    { // 새 변수 선언을 위한 블록
-        char* name = copyString(tokenString);
-        match(ID);
-        if (token == LPAREN) { // call
-            t = newExpNode(CallK);
-            t->attr.name = name;
+        case LPAREN:
             match(LPAREN);
-            t->child[0] = parse_args();
-            match(RPAREN);
+            f = pushFrame(FR_PAREN);
+            continue;
+        default:
+            fprintf(listing, "Syntax error: unexpected token -> ");
+            printToken(token, curText, curTok.len);
+            advance();
+            pushOpnd(NULL);
+            break;
         }
-        else { // var
-            t = newExpNode(IdK);
-            t->attr.name = name;
+
+        /* 2. 연산자: 이항 연산자면 다음 피연산자로, 아니면 프레임 끝 */
+        for (;;) {
+            int prec = (token <= RBRACKET) ? binPrec[token] : 0;
+
+            if (prec > 0 && !(prec == PREC_REL && f->relSeen)) {
+                TreeNode* p;
+                reduceOps(f, prec);
+                if (prec == PREC_REL) f->relSeen = TRUE;
+                p = newExpNode(OpK);
+                p->attr.op = token;
+                pushOp(p);
+                match(token);
+                break;
+            }
+
+            if (token == ASSIGN) {
+                /* '=' 는 가장 낮은 우선순위: 지금까지의 식 전체가 좌변 */
+                reduceOps(f, 0);
+                t = opnd[opndTop - 1];
+                if (t != NULL && t->nodekind == ExpK && t->kind.exp == IdK) {
+                    TreeNode* p = newExpNode(OpK);
+                    p->attr.op = ASSIGN;
+                    p->child[0] = t; // 좌변
+                    if (f->asgTail != NULL) f->asgTail->child[1] = p;
+                    else f->asgHead = p;
+                    f->asgTail = p;
+                    opndTop--;
+                    f->relSeen = FALSE;
+                    match(ASSIGN);
+                    break;
+                }
+                fprintf(listing, "Syntax error: assignment to non-variable\n");
+            }
+
+            /* 프레임 끝: 결과를 바깥 프레임의 피연산자로 */
+            t = closeFrame(f);
+            frameTop--;
+            if (frameTop == base)
+                return t;
+            if (f->kind == FR_PAREN) {
+                match(RPAREN);
+                f = &frames[frameTop - 1];
+                pushOpnd(t);
+            }
+            else { /* FR_ARG */
+                TreeNode* call = f->call;
+                if (t != NULL) {
+                    if (f->argTail != NULL) f->argTail->sibling = t;
+                    else call->child[0] = t;
+                    f->argTail = t;
+                }
+                if (token == COMMA) {
+                    /* 같은 호출의 다음 인자: 프레임을 다시 연다 */
+                    TreeNode* tail = f->argTail;
+                    match(COMMA);
+                    f = pushFrame(FR_ARG);
+                    f->call = call;
+                    f->argTail = tail;
+                    break;
+                }
+                match(RPAREN);
+                f = &frames[frameTop - 1];
+                SEM_LEAVE(call);
+                pushOpnd(call);
+            }
         }
     }
-    break;
-    case LPAREN:
-        match(LPAREN);
-        t = parse_expression();
-        match(RPAREN);
-        break;
-    default:
-        fprintf(listing, "Syntax error: unexpected token -> ");
-        printToken(token, tokenString);
-        token = getToken();
-        break;
-    }
-    return t;
 }
 
-/*
- * args -> arg-list | empty
- */
-static TreeNode* parse_args(void) {
-    // ')'가 바로 나오면 'empty'
-    if (token == RPAREN) {
-        return NULL; // 인수 없음
-    }
-    else {
-        return parse_arg_list();
+/* -------------------------------------------------- */
+/* 최상위 선언 병렬 파싱                                */
+/* -------------------------------------------------- */
+
+#define PAR_MIN_TOKENS 65536   /* 이보다 작은 입력은 순차로 */
+
+/* 작업자 하나가 맡는 토큰 구간 [begin, end) 과 결과 */
+typedef struct {
+    int begin, end;
+    TreeNode* head;   /* 선언 목록 (sibling 으로 연결) */
+    TreeNode* tail;
+    Arena arena;      /* 노드는 작업자의 arena 에 */
+    int ok;           /* 오류 없이 정확히 end 까지 파싱했는가 */
+} ParseJob;
+
+/* 최상위 선언의 경계를 괄호 짝으로 찾는다.
+ * int x; 는 ';' 에서, 함수는 본문의 '}' 에서 끝난다.
+ * 순차 파서가 선언을 계속 읽는 동안(다음 토큰이 int / void)만 나누므로,
+ * 마지막 경계 뒤는 순차 파서가 이어서 읽는다. 경계 수를 돌려준다 */
+static int findDeclBounds(int* bounds) {
+    int n = 0, depth = 0, paren = 0;
+
+    for (int i = 0; i < tokens.count; i++) {
+        switch ((TokenType)tokens.tok[i].kind) {
+        case LBRACE: depth++; break;
+        case LPAREN: paren++; break;
+        case RPAREN: paren--; break;
+        case RBRACE:
+            if (--depth < 0) return n;
+            if (depth == 0 && paren == 0) bounds[n++] = i + 1;
+            break;
+        case SEMI:
+            if (depth == 0 && paren == 0) bounds[n++] = i + 1;
+            break;
+        case ENDFILE:
+            return n;
+        default:
+            break;
+        }
+        if (n > 0 && bounds[n - 1] == i + 1) {
+            TokenType next = (TokenType)tokens.tok[i + 1].kind;
+            if (next != INT && next != VOID) return n;
+        }
     }
+    return n;
 }
 
-/*
- * arg-list -> expression { , expression }
- * (좌순환을 루프로 변경)
- */
-static TreeNode* parse_arg_list(void) {
-    TreeNode* t = parse_expression();
-    TreeNode* p = t;
-    while (token == COMMA) {
-        match(COMMA);
-        TreeNode* q = parse_expression();
-        if (q != NULL) {
-            p->sibling = q;
-            p = q;
-        }
+static void parseWorker(void* arg, int k) {
+    ParseJob* job = (ParseJob*)arg + k;
+    FILE* out = tmpfile();
+
+    /* 작업자의 출력은 버린다: 오류가 있으면 어차피 순차로 다시 파싱 */
+    listing = out;
+    Error = FALSE;
+    arenaInit(&job->arena, ARENA_BLOCK);
+    curArena = &job->arena;
+    job->head = job->tail = NULL;
+    job->ok = (out != NULL);
+
+    tokpos = job->begin;
+    token = (TokenType)curTok.kind;
+    lineno = curTok.line;
+    while (job->ok && tokpos < job->end) {
+        TreeNode* q;
+        if (token != INT && token != VOID) break;
+        q = parse_declaration();
+        if (q == NULL) break;
+        if (job->head == NULL) job->head = q;
+        else job->tail->sibling = q;
+        job->tail = q;
+    }
+    if (out != NULL) {
+        job->ok = tokpos == job->end && !Error && ftell(out) == 0;
+        fclose(out);
+    }
+    freeExprStacks();
+}
+
+/* 토큰 배열 앞부분의 최상위 선언들을 nthreads 개로 나눠 동시에 파싱한다.
+ * 성공하면 선언 목록(소스 순서)을 돌려주고 tokpos 를 그 다음으로 옮긴다.
+ * 나눌 것이 없거나 어느 구간에든 구문 오류가 있으면 NULL (순차 파서가 처음부터) */
+static TreeNode* parseDeclsParallel(int nthreads) {
+    int* bounds;
+    int nb, n, k, b;
+    ParseJob* jobs;
+    FILE* savedListing = listing;
+    Arena* savedArena = curArena;
+    int savedError = Error;
+    TreeNode* head = NULL;
+    TreeNode* tail = NULL;
+    int ok = TRUE;
+
+    if (nthreads <= 0) nthreads = cpuCount();
+    if (nthreads <= 1 || tokens.count < PAR_MIN_TOKENS) return NULL;
+    if (tokens.tok[0].kind != INT && tokens.tok[0].kind != VOID) return NULL;
+
+    bounds = (int*)malloc(sizeof(int) * tokens.count);
+    if (bounds == NULL) return NULL;
+    nb = findDeclBounds(bounds);
+    n = nb < nthreads ? nb : nthreads;
+    if (n <= 1) {
+        free(bounds);
+        return NULL;
     }
-    return t;
+
+    /* 경계를 지키며 토큰 수가 비슷하게 n 구간으로 */
+    jobs = (ParseJob*)calloc((size_t)n, sizeof(ParseJob));
+    if (jobs == NULL) {
+        free(bounds);
+        return NULL;
+    }
+    b = 0;
+    for (k = 0; k < n; k++) {
+        long long want = (long long)bounds[nb - 1] * (k + 1) / n;
+        jobs[k].begin = k ? jobs[k - 1].end : 0;
+        while (b < nb - (n - 1 - k) - 1 && bounds[b] < want)
+            b++;
+        jobs[k].end = bounds[b++];
+    }
+    free(bounds);
+
+    /* 0 번 작업자는 이 스레드에서 돈다: 스레드별 상태를 되돌린다 */
+    runParallel(n, parseWorker, jobs);
+    listing = savedListing;
+    curArena = savedArena;
+    Error = savedError;
+
+    for (k = 0; k < n; k++)
+        ok = ok && jobs[k].ok;
+    for (k = 0; k < n; k++) {
+        if (ok) {
+            /* 작업자의 노드를 이번 컴파일의 arena 로 넘기고 목록을 잇는다 */
+            arenaMerge(curArena, &jobs[k].arena);
+            if (head == NULL) head = jobs[k].head;
+            else tail->sibling = jobs[k].head;
+            tail = jobs[k].tail;
+        }
+        else
+            arenaFree(&jobs[k].arena);
+    }
+    tokpos = ok ? jobs[n - 1].end : 0;
+    token = (TokenType)curTok.kind;
+    lineno = curTok.line;
+    free(jobs);
+    return ok ? head : NULL;
 }
 
 /* * 최상위 파싱 함수 (시작점)
  */
 TreeNode* parse(void) {
     TreeNode* t;
-    token = getToken(); // 첫 번째 토큰 가져오기
-    t = parse_program();
+    // 어휘 분석 선행 패스: 전체 토큰 배열
+    if (LexThreads == 1)
+        lexAll(&tokens);
+    else
+        lexAllParallel(&tokens, LexThreads);
+    tokpos = 0;
+    token = (TokenType)curTok.kind; // 첫 번째 토큰
+    lineno = curTok.line;
+    if (ParseThreads != 1 && !FusedCheck && (t = parseDeclsParallel(ParseThreads)) != NULL) {
+        /* 병렬로 읽은 선언 뒤에 남은 선언은 순차로 이어서 */
+        TreeNode* p = t;
+        while (p->sibling != NULL) p = p->sibling;
+        while (token == INT || token == VOID) {
+            TreeNode* q = parse_declaration();
+            if (q != NULL) {
+                p->sibling = q;
+                p = q;
+            }
+        }
+    }
+    else
+        t = parse_program();
     if (token != ENDFILE) {
         fprintf(listing, "Syntax error: Code ends before file\n");
     }
+    freeTokens(&tokens);
     return t;
 }
+
+/* 파이프라인의 파싱 단계: feed 에서 토큰 블록을 받아 가며 최상위 선언을
+ * 하나씩 out 으로 보낸다 (끝은 NULL). 선언의 sibling 은 잇지 않는다
+ * (다음 단계가 읽는 중이므로 호출한 쪽이 모든 단계가 끝난 뒤에 잇는다).
+ * 출력과 오류 판정은 parse() 와 같고, Error 를 돌려준다 */
+int parseStream(SpscQueue* feed, SpscQueue* out) {
+    TreeNode* q;
+
+    tokenFeed = feed;
+    tokens.tok = NULL;
+    tokens.count = 0;
+    tokens.cap = 0;
+    needTokens(0);
+    tokpos = 0;
+    token = (TokenType)curTok.kind;
+    lineno = curTok.line;
+
+    /* parse_declaration_list 와 같은 순서. 순차 모드는 구문 오류(Error)가
+     * 있으면 분석하지 않으므로 그 뒤의 선언은 보내지 않는다 */
+    q = parse_declaration();
+    if (q != NULL && !Error) queuePush(out, q);
+    while (token == INT || token == VOID) {
+        q = parse_declaration();
+        if (q != NULL && !Error) queuePush(out, q);
+    }
+    if (token != ENDFILE) {
+        fprintf(listing, "Syntax error: Code ends before file\n");
+    }
+    queuePush(out, NULL);
+
+    /* 스캐너가 아직 보내는 블록이 있으면 마저 받아 버린다 */
+    while (tokenFeed != NULL)
+        needTokens(tokens.count);
+    freeTokens(&tokens);
+    freeExprStacks();
+    return Error;
+}
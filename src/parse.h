@@ -2,6 +2,7 @@
 #define _PARSE_H_
 
 #include "globals.h"
+#include "thread.h"
 
 /* NodeKind: 문장(Stmt), 표현식(Exp), 선언(Decl) */
 typedef enum { StmtK, ExpK, DeclK } NodeKind;
@@ -33,12 +34,18 @@ typedef struct treeNode {
     union {
         TokenType op; 
         int val;
-        char* name;
+        int atom;     /* 식별자 이름 (intern.h 의 atom) */
     } attr;
     ExpType type;
+    /* 의미 분석이 묶어 둔 심볼 (symtab.h): 선언 노드는 자기가 만든 항목,
+     * IdK / CallK 는 가리키는 선언의 항목. 분석 전이나 찾지 못하면 NULL */
+    struct BucketList* sym;
 } TreeNode;
 
 /* 파서의 시작 함수 */
 TreeNode* parse(void);
 
+/* 파이프라인 모드의 파싱 단계 (pipeline.c) */
+int parseStream(SpscQueue* feed, SpscQueue* out);
+
 #endif
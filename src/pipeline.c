@@ -0,0 +1,171 @@
+/****************************************************/
+/* File: pipeline.c                                 */
+/* Pipelined compilation for the C- compiler        */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+#include "parse.h"
+#include "semantic.h"
+#include "cgen.h"
+#include "arena.h"
+#include "thread.h"
+#include "symtab.h"
+#include "pipeline.h"
+
+#define BLOCK_QUEUE 16   /* 스캐너 → 파서: 토큰 블록 (TOKBLOCK 개씩) */
+#define DECL_QUEUE  256  /* 파서 → 분석 → 생성: 최상위 선언 */
+
+/* 단계별 listing: 끝난 뒤 순차 컴파일의 순서대로 이어 붙인다 */
+enum { LOG_SCAN, LOG_PARSE, LOG_SEM, LOG_GEN, NLOGS };
+
+typedef struct {
+    SpscQueue tokQ;      /* TokenBlock* */
+    SpscQueue declQ;     /* TreeNode*, 끝은 NULL */
+    SpscQueue checkedQ;  /* TreeNode*, 끝은 NULL */
+    FILE* log[NLOGS];
+    Arena* arena;        /* 파서가 노드를 할당할 arena */
+    Arena symArena;      /* 분석 단계가 심볼 항목을 할당할 arena (끝나면 arena 로 합침) */
+    int scanError;       /* #include 실패 */
+    int parseError;
+    int semError;
+    int ndecls;          /* 분석 단계가 받은 선언 수 */
+} Pipeline;
+
+static void scanStage(void* arg) {
+    Pipeline* pl = (Pipeline*)arg;
+
+    listing = pl->log[LOG_SCAN];
+    Error = FALSE;
+    lexStream(&pl->tokQ);
+    pl->scanError = Error;
+}
+
+static void parseStage(void* arg) {
+    Pipeline* pl = (Pipeline*)arg;
+
+    listing = pl->log[LOG_PARSE];
+    curArena = pl->arena;
+    Error = FALSE;
+    pl->parseError = parseStream(&pl->tokQ, &pl->declQ);
+}
+
+/* 순차 모드는 구문 오류가 있으면 분석하지 않으므로,
+ * 파서는 오류가 나기 전의 선언만 보낸다 (parseStream). 분석 단계도
+ * 마찬가지로 의미 오류가 나기 전의 선언만 생성 단계로 보낸다 */
+static void analyzeStage(void* arg) {
+    Pipeline* pl = (Pipeline*)arg;
+    TreeNode* t;
+
+    listing = pl->log[LOG_SEM];
+    curArena = &pl->symArena;
+    Error = FALSE;
+    initSymTab();   /* 심볼 테이블은 스레드마다 */
+    analyzeBegin();
+    while ((t = (TreeNode*)queuePop(&pl->declQ)) != NULL) {
+        pl->ndecls++;
+        analyzeDecl(t);
+        if (!Error) queuePush(&pl->checkedQ, t);
+    }
+    analyzeEnd();
+    pl->semError = Error;
+    st_freeze_globals();   /* 테이블을 주 스레드로 넘긴다 (-symstats) */
+    queuePush(&pl->checkedQ, NULL);
+}
+
+/* 단계 출력 하나를 listing 으로 옮긴다 */
+static void flushLog(FILE* f) {
+    char buf[8192];
+    size_t n;
+
+    rewind(f);
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        fwrite(buf, 1, n, listing);
+}
+
+static void startStage(Thread* t, ThreadFn fn, Pipeline* pl) {
+    if (!threadStart(t, fn, pl)) {
+        fprintf(stderr, "Error: Unable to start pipeline thread\n");
+        exit(1);
+    }
+}
+
+TreeNode* compilePipelined(char* codefile) {
+    Pipeline pl;
+    Thread scanner, parser, analyzer;
+    FILE* savedListing = listing;
+    char partfile[256];
+    TreeNode* head = NULL;
+    TreeNode* tail = NULL;
+    TreeNode* t;
+    int opened;
+
+    memset(&pl, 0, sizeof(pl));
+    for (int i = 0; i < NLOGS; i++) {
+        pl.log[i] = tmpfile();
+        if (pl.log[i] == NULL) {
+            fprintf(stderr, "Error: Unable to create pipeline buffer\n");
+            exit(1);
+        }
+    }
+    queueInit(&pl.tokQ, BLOCK_QUEUE);
+    queueInit(&pl.declQ, DECL_QUEUE);
+    queueInit(&pl.checkedQ, DECL_QUEUE);
+    pl.arena = curArena;
+    arenaInit(&pl.symArena, ARENA_BLOCK);
+
+    startStage(&scanner, scanStage, &pl);
+    startStage(&parser, parseStage, &pl);
+    startStage(&analyzer, analyzeStage, &pl);
+
+    /* 생성 단계 (이 스레드): 오류가 나면 지울 수 있도록 임시 파일에 쓴다 */
+    listing = pl.log[LOG_GEN];
+    snprintf(partfile, sizeof(partfile), "%s.part", codefile);
+    opened = codeGenBegin(codefile, partfile);
+    while ((t = (TreeNode*)queuePop(&pl.checkedQ)) != NULL) {
+        if (opened) codeGenDecl(t);
+        if (head == NULL) head = t;
+        else tail->sibling = t;
+        tail = t;
+    }
+
+    if (opened) codeGenEnd();
+    listing = savedListing;
+
+    threadJoin(analyzer);
+    threadJoin(parser);
+    threadJoin(scanner);
+    arenaMerge(pl.arena, &pl.symArena);
+    freeSymTab();
+    st_thaw_globals();
+    Error = pl.scanError || pl.parseError || pl.semError;
+
+    /* 순차 모드와 같은 순서로 출력: 스캔, 파싱, 분석, 트리, 생성 */
+    flushLog(pl.log[LOG_SCAN]);
+    flushLog(pl.log[LOG_PARSE]);
+    if (!pl.scanError && !pl.parseError && pl.ndecls > 0)
+        flushLog(pl.log[LOG_SEM]);
+    if (TraceParse && !Error) {
+        fprintf(listing, "\nSyntax tree:\n");
+        printTree(head);
+    }
+    if (!Error)
+        flushLog(pl.log[LOG_GEN]);
+
+    if (opened) {
+        if (!Error) {
+            remove(codefile);
+            rename(partfile, codefile);
+        }
+        else
+            remove(partfile);
+    }
+
+    for (int i = 0; i < NLOGS; i++)
+        fclose(pl.log[i]);
+    queueFree(&pl.tokQ);
+    queueFree(&pl.declQ);
+    queueFree(&pl.checkedQ);
+    return head;
+}
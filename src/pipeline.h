@@ -0,0 +1,19 @@
+/****************************************************/
+/* File: pipeline.h                                 */
+/* Pipelined compilation for the C- compiler        */
+/****************************************************/
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* 스캐너, 파서, 의미 분석기를 각자의 스레드에서, Java 생성을 호출한
+ * 스레드에서 돌리고 단계 사이는 lock-free 큐로 잇는다.
+ *   스캐너 --토큰 블록--> 파서 --최상위 선언--> 분석 --검사한 선언--> 생성
+ * listing 출력, Error, 출력 파일은 순차 컴파일(parse → analyze → 트리 출력
+ * → codeGen)과 같다. 선언 목록을 돌려준다 */
+TreeNode* compilePipelined(char* codefile);
+
+#endif
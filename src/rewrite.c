@@ -0,0 +1,357 @@
+/****************************************************/
+/* File: rewrite.c                                  */
+/* Table-driven algebraic rewrites for C-           */
+/****************************************************/
+
+#include "globals.h"
+#include "util.h"
+#include "arena.h"
+#include "symtab.h"
+#include "visit.h"
+#include "rewrite.h"
+
+/* 규칙은 S-식 패턴 두 개로 적는다.
+ *   (op x y)  연산 노드. op 는 + - * / % << >> >>>
+ *   a ... z   아무 식. 같은 글자가 두 번 나오면 같은 식이어야 한다
+ *   정수      그 값의 상수 (-1 처럼 음수도)
+ *   #pow      2 이상인 2 의 거듭제곱 상수 (지수를 기억한다)
+ *   #log      오른쪽에서만: 그 지수,  #clog: 32 - 지수
+ * 왼쪽과 오른쪽에 나오는 횟수가 다르거나 왼쪽에 두 번 이상 나오는 식은
+ * 계산 횟수가 바뀌므로 호출이나 대입이 없는 식일 때만 맞는다 */
+typedef struct {
+    const char* name;
+    const char* from;
+    const char* to;
+} RewriteRule;
+
+/* 먼저 맞는 규칙이 이긴다. 나머지 꼴은 안쪽의 나눗셈이 시프트로 바뀌기 전에 본다 */
+static const RewriteRule rules[] = {
+    { "mod-idiom",   "(- a (* (/ a b) b))", "(% a b)" },
+    { "mod-idiom2",  "(- a (* b (/ a b)))", "(% a b)" },
+    { "add-zero",    "(+ a 0)",             "a" },
+    { "zero-add",    "(+ 0 a)",             "a" },
+    { "sub-zero",    "(- a 0)",             "a" },
+    { "sub-self",    "(- a a)",             "0" },
+    { "mul-one",     "(* a 1)",             "a" },
+    { "one-mul",     "(* 1 a)",             "a" },
+    { "mul-zero",    "(* a 0)",             "0" },
+    { "zero-mul",    "(* 0 a)",             "0" },
+    { "div-one",     "(/ a 1)",             "a" },
+    { "div-neg-one", "(/ a -1)",            "(- 0 a)" },
+    { "mod-one",     "(% a 1)",             "0" },
+    { "mul-pow2",    "(* a #pow)",          "(<< a #log)" },
+    { "pow2-mul",    "(* #pow a)",          "(<< a #log)" },
+    /* 0 쪽으로 자르므로 음수는 2^k - 1 을 더한 뒤 민다 */
+    { "div-pow2",    "(/ a #pow)",          "(>> (+ a (>>> (>> a 31) #clog)) #log)" },
+};
+
+#define NRULES ((int)(sizeof(rules) / sizeof(rules[0])))
+#define MAX_PAT 512
+#define NVARS 26
+
+typedef enum { PAT_OP, PAT_VAR, PAT_CONST, PAT_POW, PAT_LOG, PAT_CLOG } PatKind;
+
+typedef struct Pat {
+    PatKind kind;
+    int value;              /* OP: 연산, VAR: 글자 번호, CONST: 값 */
+    struct Pat* kid[2];
+} Pat;
+
+typedef struct {
+    Pat* from;
+    Pat* to;
+    int pure;               /* 비트 v: 글자 v 는 부작용 없는 식이어야 한다 */
+} Compiled;
+
+static Pat pool[MAX_PAT];
+static int npool = 0;
+static Compiled compiled[NRULES];
+static int ready = FALSE;
+
+static void badRule(const char* text)
+{
+    fprintf(stderr, "Error: bad rewrite rule \"%s\"\n", text);
+    exit(1);
+}
+
+static const char* skipSpace(const char* s)
+{
+    while (*s == ' ') s++;
+    return s;
+}
+
+static int parseOp(const char** s)
+{
+    static const struct { const char* text; TokenType op; } ops[] = {
+        { ">>>", USHR }, { ">>", SHR }, { "<<", SHL },
+        { "+", PLUS }, { "-", MINUS }, { "*", TIMES }, { "/", OVER }, { "%", MOD },
+    };
+    for (int i = 0; i < (int)(sizeof(ops) / sizeof(ops[0])); i++) {
+        size_t n = strlen(ops[i].text);
+        if (strncmp(*s, ops[i].text, n) == 0 && (*s)[n] == ' ') {
+            *s += n;
+            return ops[i].op;
+        }
+    }
+    return -1;
+}
+
+static Pat* parsePat(const char** s, const char* text)
+{
+    Pat* p;
+
+    *s = skipSpace(*s);
+    if (npool == MAX_PAT) badRule(text);
+    p = &pool[npool++];
+    p->kid[0] = p->kid[1] = NULL;
+
+    if (**s == '(') {
+        (*s)++;
+        p->kind = PAT_OP;
+        p->value = parseOp(s);
+        if (p->value < 0) badRule(text);
+        p->kid[0] = parsePat(s, text);
+        p->kid[1] = parsePat(s, text);
+        *s = skipSpace(*s);
+        if (**s != ')') badRule(text);
+        (*s)++;
+    }
+    else if (**s >= 'a' && **s <= 'z') {
+        p->kind = PAT_VAR;
+        p->value = *(*s)++ - 'a';
+    }
+    else if (**s == '-' || (**s >= '0' && **s <= '9')) {
+        char* end;
+        p->kind = PAT_CONST;
+        p->value = (int)strtol(*s, &end, 10);
+        if (end == *s) badRule(text);
+        *s = end;
+    }
+    else if (strncmp(*s, "#pow", 4) == 0) { p->kind = PAT_POW;  *s += 4; }
+    else if (strncmp(*s, "#log", 4) == 0) { p->kind = PAT_LOG;  *s += 4; }
+    else if (strncmp(*s, "#clog", 5) == 0) { p->kind = PAT_CLOG; *s += 5; }
+    else
+        badRule(text);
+    return p;
+}
+
+static Pat* compilePat(const char* text)
+{
+    const char* s = text;
+    Pat* p = parsePat(&s, text);
+    if (*skipSpace(s) != '\0') badRule(text);
+    return p;
+}
+
+static void countVars(const Pat* p, int* count)
+{
+    if (p == NULL) return;
+    if (p->kind == PAT_VAR) count[p->value]++;
+    countVars(p->kid[0], count);
+    countVars(p->kid[1], count);
+}
+
+static void compileRules(void)
+{
+    for (int i = 0; i < NRULES; i++) {
+        int from[NVARS] = { 0 }, to[NVARS] = { 0 };
+        Compiled* c = &compiled[i];
+
+        c->from = compilePat(rules[i].from);
+        c->to = compilePat(rules[i].to);
+        countVars(c->from, from);
+        countVars(c->to, to);
+        c->pure = 0;
+        for (int v = 0; v < NVARS; v++) {
+            if (to[v] > 0 && from[v] == 0) badRule(rules[i].to);
+            if (from[v] > 1 || to[v] != from[v]) c->pure |= 1 << v;
+        }
+    }
+    ready = TRUE;
+}
+
+/* =================================================== */
+/* 맞추기와 만들기                                       */
+/* =================================================== */
+typedef struct {
+    TreeNode* var[NVARS];
+    int used[NVARS];        /* 오른쪽에서 이미 쓴 횟수 (두 번째부터는 복사) */
+    int log;
+} Binding;
+
+static int isConstNode(const TreeNode* t)
+{
+    return t != NULL && t->nodekind == ExpK && t->kind.exp == ConstK;
+}
+
+/* 호출과 대입이 없고, 0 일 수 있는 수로 나누지도 않는 식 (지우거나 복사해도 된다) */
+static int isPure(const TreeNode* t)
+{
+    if (t == NULL) return TRUE;
+    if (t->nodekind != ExpK) return FALSE;
+    switch (t->kind.exp) {
+    case ConstK:
+    case IdK:
+        return TRUE;
+    case OpK:
+        if (t->attr.op == ASSIGN) return FALSE;
+        if ((t->attr.op == OVER || t->attr.op == MOD) &&
+            (!isConstNode(t->child[1]) || t->child[1]->attr.val == 0))
+            return FALSE;
+        return isPure(t->child[0]) && isPure(t->child[1]);
+    default:
+        return FALSE;
+    }
+}
+
+static int sameTree(const TreeNode* a, const TreeNode* b)
+{
+    if (a == NULL || b == NULL) return a == b;
+    if (a->nodekind != ExpK || b->nodekind != ExpK || a->kind.exp != b->kind.exp) return FALSE;
+    switch (a->kind.exp) {
+    case ConstK:
+        return a->attr.val == b->attr.val;
+    case IdK:
+        return a->attr.atom == b->attr.atom && a->sym == b->sym;
+    case OpK:
+        return a->attr.op == b->attr.op &&
+               sameTree(a->child[0], b->child[0]) && sameTree(a->child[1], b->child[1]);
+    default:
+        return FALSE;
+    }
+}
+
+static int match(const Pat* p, TreeNode* t, Binding* b)
+{
+    if (t == NULL || t->nodekind != ExpK) return FALSE;
+    switch (p->kind) {
+    case PAT_OP:
+        return t->kind.exp == OpK && t->attr.op == (TokenType)p->value &&
+               match(p->kid[0], t->child[0], b) && match(p->kid[1], t->child[1], b);
+    case PAT_VAR:
+        if (b->var[p->value] == NULL) {
+            b->var[p->value] = t;
+            return TRUE;
+        }
+        return sameTree(b->var[p->value], t);
+    case PAT_CONST:
+        return isConstNode(t) && t->attr.val == p->value;
+    case PAT_POW:
+    {
+        int v = isConstNode(t) ? t->attr.val : 0;
+        if (v < 2 || (v & (v - 1)) != 0) return FALSE;
+        for (b->log = 0; (1 << b->log) != v; b->log++)
+            ;
+        return TRUE;
+    }
+    default:
+        return FALSE;
+    }
+}
+
+static TreeNode* copyTree(const TreeNode* t)
+{
+    TreeNode* c;
+    if (t == NULL) return NULL;
+    c = (TreeNode*)arenaAlloc(curArena, sizeof(TreeNode));
+    *c = *t;
+    c->sibling = NULL;
+    for (int k = 0; k < MAXCHILDREN; k++)
+        c->child[k] = copyTree(t->child[k]);
+    return c;
+}
+
+static TreeNode* constNode(int value, int line)
+{
+    TreeNode* t = newExpNode(ConstK);
+    t->attr.val = value;
+    t->type = Integer;
+    t->lineno = line;
+    return t;
+}
+
+static TreeNode* build(const Pat* p, Binding* b, int line)
+{
+    TreeNode* t;
+
+    switch (p->kind) {
+    case PAT_VAR:
+        /* 식은 한 곳에만 달려야 하므로 두 번째부터는 복사 */
+        return b->used[p->value]++ == 0 ? b->var[p->value] : copyTree(b->var[p->value]);
+    case PAT_CONST:
+        return constNode(p->value, line);
+    case PAT_LOG:
+        return constNode(b->log, line);
+    case PAT_CLOG:
+        return constNode(32 - b->log, line);
+    default:
+        t = newExpNode(OpK);
+        t->attr.op = (TokenType)p->value;
+        t->type = Integer;
+        t->lineno = line;
+        t->child[0] = build(p->kid[0], b, line);
+        t->child[1] = build(p->kid[1], b, line);
+        return t;
+    }
+}
+
+static int tryRule(const Compiled* c, TreeNode* t)
+{
+    Binding b;
+    TreeNode* r;
+    TreeNode* sib;
+
+    memset(&b, 0, sizeof(b));
+    if (!match(c->from, t, &b)) return FALSE;
+    for (int v = 0; v < NVARS; v++)
+        if ((c->pure & (1 << v)) && b.var[v] != NULL && !isPure(b.var[v])) return FALSE;
+
+    /* 자리를 바꾸지 않고 노드 내용을 덮어쓴다 (형제 목록은 그대로) */
+    r = build(c->to, &b, t->lineno);
+    sib = t->sibling;
+    *t = *r;
+    t->sibling = sib;
+    return TRUE;
+}
+
+typedef struct {
+    long changed;
+} RewriteCtx;
+
+static void rewriteNode(RewriteCtx* ctx, TreeNode* t)
+{
+    int again = TRUE;
+
+    while (again && t->nodekind == ExpK && t->kind.exp == OpK) {
+        again = FALSE;
+        for (int i = 0; i < NRULES; i++) {
+            if (tryRule(&compiled[i], t)) {
+                ctx->changed++;
+                again = TRUE;
+                break;
+            }
+        }
+    }
+}
+
+/* 위에서 한 번 (u - u/v*v 처럼 큰 꼴 먼저), 자식이 바뀐 뒤 아래에서 한 번 */
+static int rewritePre(RewriteCtx* ctx, TreeNode* t)
+{
+    rewriteNode(ctx, t);
+    return VISIT_ALL;
+}
+
+#define REWRITE_PRE(ctx, t, p, slot, d)  rewritePre(ctx, t)
+#define REWRITE_POST(ctx, t, p, slot)    rewriteNode(ctx, t)
+DEFINE_TREE_VISITOR(rewriteAll, RewriteCtx, REWRITE_PRE, VISIT_NOMID, VISIT_NOSIB, REWRITE_POST)
+
+TreeNode* rewriteTrees(TreeNode* tree, long* changed)
+{
+    RewriteCtx ctx;
+
+    if (!ready) compileRules();
+    ctx.changed = 0;
+    rewriteAll(&ctx, tree);
+    *changed = ctx.changed;
+    return tree;
+}
@@ -0,0 +1,16 @@
+/****************************************************/
+/* File: rewrite.h                                  */
+/* Table-driven algebraic rewrites for C-           */
+/****************************************************/
+
+#ifndef _REWRITE_H_
+#define _REWRITE_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* rewrite (트리): rewrite.c 의 규칙 표를 OpK 트리에 더 이상 맞는 것이 없을 때까지 적용한다.
+ * 항등식, 2 의 거듭제곱 곱셈 / 나눗셈의 시프트, u - u/v*v 의 나머지(%) 등 */
+TreeNode* rewriteTrees(TreeNode* tree, long* changed);
+
+#endif
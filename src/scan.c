@@ -6,7 +6,9 @@
 #include "globals.h"
 #include "util.h"
 #include "scan.h"
-#include <string.h>
+#include "scansimd.h"
+#include "intern.h"
+#include "include.h"
 
 /* DFA states */
 typedef enum
@@ -24,38 +26,46 @@ typedef enum
     DONE
 } StateType;
 
-/* lexeme of identifier or reserved word */
-char tokenString[MAXTOKENLEN + 1];
+/* lexeme of identifier or reserved word: source.buf 안의 조각 */
+int tokenStart = 0;
+int tokenLen = 0;
 
-#define BUFLEN 256
-static char lineBuf[BUFLEN];
-static int linepos = 0;
-static int bufsize = 0;
+static ScanState scanner;   /* getToken() 이 쓰는 스캐너 상태 */
+static const char* echoSrc = NULL; /* 에코 중인 소스 */
+static int echoed = 0;      /* EchoSource 로 출력한 마지막 줄 */
 
-static int getNextChar(void)
+static int getNextChar(ScanState* ss)
 {
-    if (!(linepos < bufsize))
+    if (ss->pos < ss->len)
     {
-        lineno++;
-        if (fgets(lineBuf, BUFLEN - 1, source))
-        {
-            if (EchoSource)
-                fprintf(listing, "%4d: %s", lineno, lineBuf);
-            bufsize = strlen(lineBuf);
-            linepos = 0;
-            return (unsigned char)lineBuf[linepos++];
-        }
-        else
-            return EOF;
+        ss->last = ss->pos;
+        return (unsigned char)ss->buf[ss->pos++];
     }
-    else
-        return (unsigned char)lineBuf[linepos++];
+    ss->last = ss->len;
+    ss->pos = ss->len + 1; /* ungetNextChar 후에도 EOF 유지 */
+    return EOF;
+}
+
+static void ungetNextChar(ScanState* ss)
+{
+    if (ss->pos > 0)
+        ss->pos--;
 }
 
-static void ungetNextChar(void)
+/* 스캐너가 지나간 줄들을 last 줄까지 출력 */
+static void echoLines(int last)
 {
-    if (linepos > 0)
-        linepos--;
+    if (echoSrc != source.buf)
+    {
+        echoSrc = source.buf;
+        echoed = 0;
+    }
+    while (echoed < last)
+    {
+        int len;
+        int start = srcLineSpan(&source, ++echoed, &len);
+        fprintf(listing, "%4d: %.*s", echoed, len, source.buf + start);
+    }
 }
 
 /* reserved words table */
@@ -66,25 +76,123 @@ static struct
 } reservedWords[MAXRESERVED] = {
     {"else", ELSE}, {"if", IF}, {"int", INT}, {"return", RETURN}, {"void", VOID}, {"while", WHILE}};
 
-static TokenType reservedLookup(char *s)
+/* 선형 탐색 (switch 기반 기준 스캐너용) */
+static TokenType reservedLookupLinear(const char *s, int len)
 {
     for (int i = 0; i < MAXRESERVED; i++)
-        if (!strcmp(s, reservedWords[i].str))
+        if (!strncmp(s, reservedWords[i].str, len) && reservedWords[i].str[len] == '\0')
             return reservedWords[i].tok;
     return ID;
 }
 
-/* main scanner routine */
-TokenType getToken(void)
+/* 예약어 완전 해시 (perfect hash).
+ * 처음 한 번 reservedWords 에서 충돌이 없는 seed 와 표 크기를 찾아 두므로
+ * MAXRESERVED 가 늘어나도 그대로 동작한다. 식별자마다 비교는 많아야 한 번 */
+#define KW_MAXSLOTS 1024
+
+static unsigned char kwSlot[KW_MAXSLOTS]; /* 예약어 번호 + 1, 빈 칸은 0 */
+static int kwLen[MAXRESERVED];
+static unsigned int kwSeed, kwMask;
+static int kwFull;                        /* 1: 모든 문자를 해시 */
+static int kwMinLen, kwMaxLen;
+
+static unsigned int kwHash(const char *s, int len, unsigned int seed, int full)
+{
+    unsigned int h = seed ^ (unsigned int)len;
+    if (full)
+    {
+        for (int i = 0; i < len; i++)
+            h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    else
+    {
+        /* 첫 글자, 가운데 글자, 끝 글자와 길이만 본다 */
+        h = (h ^ (unsigned char)s[0]) * 16777619u;
+        h = (h ^ (unsigned char)s[len / 2]) * 16777619u;
+        h = (h ^ (unsigned char)s[len - 1]) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+static int tryReservedHash(unsigned int seed, unsigned int size, int full)
+{
+    memset(kwSlot, 0, sizeof(kwSlot));
+    for (int i = 0; i < MAXRESERVED; i++)
+    {
+        unsigned int h = kwHash(reservedWords[i].str, kwLen[i], seed, full) & (size - 1);
+        if (kwSlot[h] != 0)
+            return FALSE;
+        kwSlot[h] = (unsigned char)(i + 1);
+    }
+    kwSeed = seed;
+    kwMask = size - 1;
+    kwFull = full;
+    return TRUE;
+}
+
+static void buildReservedHash(void)
+{
+    unsigned int size = 1;
+
+    kwMinLen = 1 << 30;
+    kwMaxLen = 0;
+    for (int i = 0; i < MAXRESERVED; i++)
+    {
+        kwLen[i] = (int)strlen(reservedWords[i].str);
+        if (kwLen[i] < kwMinLen) kwMinLen = kwLen[i];
+        if (kwLen[i] > kwMaxLen) kwMaxLen = kwLen[i];
+    }
+    while (size < 2 * MAXRESERVED)
+        size *= 2;
+
+    /* 싼 해시부터: 글자 3개 → 전체 문자열, 표 크기는 점점 키운다 */
+    for (int full = 0; full <= 1; full++)
+        for (unsigned int n = size; n <= KW_MAXSLOTS; n *= 2)
+            for (unsigned int seed = 1; seed < 4096; seed++)
+                if (tryReservedHash(seed, n, full))
+                    return;
+
+    fprintf(stderr, "Error: cannot build perfect hash for reserved words\n");
+    exit(1);
+}
+
+static TokenType reservedLookup(const char *s, int len)
+{
+    int i;
+
+    if (len < kwMinLen || len > kwMaxLen)
+        return ID;
+    i = kwSlot[kwHash(s, len, kwSeed, kwFull) & kwMask];
+    if (i != 0 && kwLen[i - 1] == len && memcmp(s, reservedWords[i - 1].str, len) == 0)
+        return reservedWords[i - 1].tok;
+    return ID;
+}
+
+int numberValue(const char* s, int len)
+{
+    unsigned int v = 0;
+    for (int i = 0; i < len; i++)
+        v = v * 10 + (unsigned int)(s[i] - '0');
+    return (int)v;
+}
+
+int tokenNumber(void)
+{
+    return numberValue(tokenText, tokenLen);
+}
+
+/* 기존 switch 기반 DFA: 문자마다 조건 분기를 거친다.
+ * 표 기반 scanNext() 와 같은 토큰을 내므로 벤치마크 비교 기준으로 남겨 둔다 */
+TokenType scanNextSwitch(ScanState* ss)
 {
-    int tokenStringIndex = 0;
     TokenType currentToken = ERROR;
     StateType state = START;
     int save; // 문자인지 숫자인지 구별할 변수
+    int started = FALSE;
 
     while (state != DONE)
     {
-        int c = getNextChar();
+        int c = getNextChar(ss);
         save = TRUE;
 
         switch (state)
@@ -110,7 +218,7 @@ TokenType getToken(void)
                 state = INNEQ;
             else if (c == '/')
                 state = INDIV;
-            else if ((c == ' ') || (c == '\t') || (c == '\n'))
+            else if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r'))
                 save = FALSE;
             else
             {
@@ -160,7 +268,7 @@ TokenType getToken(void)
         case INNUM:
             if (!isdigit(c))
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 state = DONE;
                 currentToken = NUM;
@@ -170,7 +278,7 @@ TokenType getToken(void)
         case INID:
             if (!isalpha(c) && !isdigit(c))
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 state = DONE;
                 currentToken = ID;
@@ -183,7 +291,7 @@ TokenType getToken(void)
                 currentToken = EQ;
             else
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 currentToken = ASSIGN;
             }
@@ -195,7 +303,7 @@ TokenType getToken(void)
                 currentToken = NEQ;
             else
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 currentToken = ERROR;
             }
@@ -207,7 +315,7 @@ TokenType getToken(void)
                 currentToken = LTE;
             else
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 currentToken = LT;
             }
@@ -219,7 +327,7 @@ TokenType getToken(void)
                 currentToken = GTE;
             else
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 save = FALSE;
                 currentToken = GT;
             }
@@ -230,11 +338,11 @@ TokenType getToken(void)
             {
                 save = FALSE;
                 state = INCOMM;
-                tokenStringIndex = 0;
+                started = FALSE;
             }
             else
             {
-                ungetNextChar();
+                ungetNextChar(ss);
                 state = DONE;
                 currentToken = OVER;
             }
@@ -274,22 +382,485 @@ TokenType getToken(void)
             break;
         }
 
-        if (save && (tokenStringIndex <= MAXTOKENLEN))
-            tokenString[tokenStringIndex++] = (char)c;
+        /* 토큰의 첫 문자 위치 기록 (주석이 끝나면 새로 시작) */
+        if (save && !started)
+        {
+            ss->start = ss->pos - 1;
+            started = TRUE;
+        }
 
         if (state == DONE)
         {
-            tokenString[tokenStringIndex] = '\0';
+            if (ss->pos > ss->len)
+                ss->pos = ss->len;
+            if (!started)
+                ss->start = ss->pos;
             if (currentToken == ID)
-                currentToken = reservedLookup(tokenString);
+                currentToken = reservedLookupLinear(ss->buf + ss->start, ss->pos - ss->start);
+        }
+    }
+
+    return currentToken;
+}
+
+/* -------------------------------------------------- */
+/* 표 기반 DFA                                        */
+/* -------------------------------------------------- */
+
+/* 문자 종류 (256 바이트 → 종류 번호) */
+typedef enum
+{
+    CC_OTHER, CC_NUL, CC_SPACE, CC_DIGIT, CC_ALPHA,
+    CC_LT, CC_GT, CC_EQ, CC_BANG, CC_SLASH, CC_STAR,
+    CC_PLUS, CC_MINUS, CC_SEMI, CC_COMMA,
+    CC_LPAREN, CC_RPAREN, CC_LBRACE, CC_RBRACE, CC_LBRACKET, CC_RBRACKET,
+    NCLASS
+} CharClass;
+
+/* 전이표 항목: 하위 8비트는 다음 상태 또는 (T_ACCEPT 일 때) 토큰 종류 */
+#define T_ACCEPT 0x100  /* 토큰 인식 완료 */
+#define T_TAKE   0x200  /* 이 문자까지 토큰에 포함 (아니면 한 글자 미리보기) */
+#define T_EOF    0x400  /* '\0': 버퍼 끝인지 확인 필요 */
+#define T_FAST   0x800  /* 긴 구간(공백, 식별자, 숫자, 주석)은 SIMD 커널로 건너뜀 */
+
+static unsigned char charClass[256];
+static unsigned short transition[DONE][NCLASS];
+static unsigned short eofAction[DONE];
+static int tablesReady = FALSE;
+
+/* 한 글자 토큰 */
+static const struct
+{
+    char c;
+    CharClass cls;
+    TokenType tok;
+} singleTokens[] = {
+    {'+', CC_PLUS, PLUS}, {'-', CC_MINUS, MINUS}, {'*', CC_STAR, TIMES},
+    {';', CC_SEMI, SEMI}, {',', CC_COMMA, COMMA},
+    {'(', CC_LPAREN, LPAREN}, {')', CC_RPAREN, RPAREN},
+    {'{', CC_LBRACE, LBRACE}, {'}', CC_RBRACE, RBRACE},
+    {'[', CC_LBRACKET, LBRACKET}, {']', CC_RBRACKET, RBRACKET}};
+
+#define NSINGLE ((int)(sizeof(singleTokens) / sizeof(singleTokens[0])))
+
+/* state 에서 모든 문자에 대해 같은 동작 */
+static void fillState(StateType state, unsigned short action)
+{
+    for (int k = 0; k < NCLASS; k++)
+        transition[state][k] = action;
+    transition[state][CC_NUL] = T_EOF;
+}
+
+/* 두 글자 연산자 (<=, >=, ==, !=): '=' 가 오면 long, 아니면 short */
+static void fillPair(StateType state, TokenType shortTok, TokenType longTok)
+{
+    fillState(state, T_ACCEPT | shortTok);
+    transition[state][CC_EQ] = T_ACCEPT | T_TAKE | longTok;
+    eofAction[state] = T_ACCEPT | shortTok;
+}
+
+static void buildScanTables(void)
+{
+    int c;
+
+    for (c = 0; c < 256; c++)
+        charClass[c] = CC_OTHER;
+    charClass[0] = CC_NUL;
+    charClass[' '] = charClass['\t'] = charClass['\n'] = charClass['\r'] = CC_SPACE;
+    for (c = '0'; c <= '9'; c++)
+        charClass[c] = CC_DIGIT;
+    for (c = 'a'; c <= 'z'; c++)
+        charClass[c] = charClass[c - 'a' + 'A'] = CC_ALPHA;
+    charClass['<'] = CC_LT;
+    charClass['>'] = CC_GT;
+    charClass['='] = CC_EQ;
+    charClass['!'] = CC_BANG;
+    charClass['/'] = CC_SLASH;
+    for (int i = 0; i < NSINGLE; i++)
+        charClass[(unsigned char)singleTokens[i].c] = singleTokens[i].cls;
+
+    /* START: 공백은 건너뛰고, 한 글자 토큰은 바로 인식 */
+    fillState(START, T_ACCEPT | T_TAKE | ERROR);
+    transition[START][CC_SPACE] = START | T_FAST;
+    transition[START][CC_DIGIT] = INNUM | T_FAST;
+    transition[START][CC_ALPHA] = INID | T_FAST;
+    transition[START][CC_LT] = INLT;
+    transition[START][CC_GT] = INGT;
+    transition[START][CC_EQ] = INEQ;
+    transition[START][CC_BANG] = INNEQ;
+    transition[START][CC_SLASH] = INDIV;
+    for (int i = 0; i < NSINGLE; i++)
+        transition[START][singleTokens[i].cls] = T_ACCEPT | T_TAKE | singleTokens[i].tok;
+    eofAction[START] = T_ACCEPT | ENDFILE;
+
+    fillState(INNUM, T_ACCEPT | NUM);
+    transition[INNUM][CC_DIGIT] = INNUM;
+    eofAction[INNUM] = T_ACCEPT | NUM;
+
+    fillState(INID, T_ACCEPT | ID);
+    transition[INID][CC_DIGIT] = INID;
+    transition[INID][CC_ALPHA] = INID;
+    eofAction[INID] = T_ACCEPT | ID;
+
+    fillPair(INLT, LT, LTE);
+    fillPair(INGT, GT, GTE);
+    fillPair(INEQ, ASSIGN, EQ);
+    fillPair(INNEQ, ERROR, NEQ);
+
+    /* '/' 다음이 '*' 이면 주석, 아니면 OVER */
+    fillState(INDIV, T_ACCEPT | OVER);
+    transition[INDIV][CC_STAR] = INCOMM | T_FAST;
+    eofAction[INDIV] = T_ACCEPT | OVER;
+
+    fillState(INCOMM, INCOMM);
+    transition[INCOMM][CC_STAR] = OUTCOMM;
+    eofAction[INCOMM] = T_ACCEPT | ENDFILE;
+
+    fillState(OUTCOMM, INCOMM | T_FAST);
+    transition[OUTCOMM][CC_STAR] = OUTCOMM;
+    transition[OUTCOMM][CC_SLASH] = START;
+    eofAction[OUTCOMM] = T_ACCEPT | ENDFILE;
+
+    buildReservedHash();
+    tablesReady = TRUE;
+}
+
+void initScanTables(void)
+{
+    if (!tablesReady)
+        buildScanTables();
+    initScanSimd();
+}
+
+void scanInit(ScanState* ss, const char* buf, int len)
+{
+    initScanTables();
+    ss->buf = buf;
+    ss->len = len;
+    ss->pos = 0;
+    ss->start = 0;
+    ss->last = 0;
+}
+
+/* 표 기반 스캐너: 문자마다 종류표와 전이표를 한 번씩 읽는다.
+ * T_FAST 전이 뒤에는 같은 종류의 문자가 끝나는 곳까지 커널로 건너뛴다 */
+TokenType scanNext(ScanState* ss)
+{
+    const unsigned char* buf = (const unsigned char*)ss->buf;
+    int pos = ss->pos;
+    int start = pos;
+    int state = START;
+    unsigned int action;
+    TokenType tok;
+
+    for (;;)
+    {
+        if (state == START)
+            start = pos;
+        action = transition[state][charClass[buf[pos]]];
+        if (action & T_EOF)
+        {
+            /* '\0' 이 버퍼 끝이 아니면 일반 문자로 취급 */
+            if (pos >= ss->len)
+                action = eofAction[state];
+            else
+                action = transition[state][CC_OTHER];
+        }
+        if (action & T_ACCEPT)
+            break;
+        state = (int)(action & 0xff);
+        pos++;
+        /* 한 글자로 끝나는 구간은 커널을 부르지 않는다 */
+        if ((action & T_FAST) &&
+            (transition[state][charClass[buf[pos]]] & ~T_FAST) == (unsigned int)state)
+        {
+            switch (state)
+            {
+            case START:
+                pos = scanKernels.spaces(ss->buf, pos, ss->len);
+                break;
+            case INID:
+                pos = scanKernels.ident(ss->buf, pos, ss->len);
+                break;
+            case INNUM:
+                pos = scanKernels.digits(ss->buf, pos, ss->len);
+                break;
+            case INCOMM:
+                /* 주석 끝을 찾으면 바로 START 로, 못 찾으면 EOF 까지 */
+                pos = scanKernels.commentEnd(ss->buf, pos, ss->len);
+                if (pos >= 0)
+                    state = START;
+                else
+                    pos = ss->len;
+                break;
+            default:
+                break;
+            }
         }
     }
 
+    ss->last = pos;
+    if (action & T_TAKE)
+        pos++;
+    tok = (TokenType)(action & 0xff);
+    if (tok == ENDFILE)
+        start = pos;
+    else if (tok == ID)
+        tok = reservedLookup(ss->buf + start, pos - start);
+
+    ss->start = start;
+    ss->pos = pos;
+    return tok;
+}
+
+/* main scanner routine */
+TokenType getToken(void)
+{
+    TokenType currentToken;
+
+    if (scanner.buf != source.buf)
+        scanInit(&scanner, source.buf, source.len);
+
+    currentToken = scanNext(&scanner);
+    tokenStart = scanner.start;
+    tokenLen = scanner.pos - scanner.start;
+    /* #include "파일": lexeme 은 파일 이름 */
+    if (currentToken == ERROR && source.buf[tokenStart] == '#' &&
+        scanDirective(&scanner, &tokenStart, &tokenLen))
+        currentToken = INCLUDE;
+
+    /* 줄 번호는 마지막으로 들여다본 문자의 위치에서 계산 */
+    lineno = srcLineOf(&source, scanner.last);
+    /* EOF 를 읽었으면 lineno 는 마지막 줄 + 1 */
+    if (EchoSource)
+        echoLines(scanner.last >= source.len ? lineno - 1 : lineno);
+
     if (TraceScan)
     {
         fprintf(listing, "\t%d: ", lineno);
-        printToken(currentToken, tokenString);
+        printToken(currentToken, tokenText, tokenLen);
     }
 
     return currentToken;
 }
+
+void pushToken(TokenArray* ta, const Token* t)
+{
+    if (ta->count == ta->cap)
+    {
+        int cap = ta->cap ? ta->cap * 2 : 4096;
+        Token* p = (Token*)realloc(ta->tok, sizeof(Token) * cap);
+        if (p == NULL)
+        {
+            fprintf(listing, "Error: Out of memory for token array\n");
+            exit(1);
+        }
+        ta->tok = p;
+        ta->cap = cap;
+    }
+    ta->tok[ta->count++] = *t;
+}
+
+void listToken(const Token* t)
+{
+    if (EchoSource)
+        echoLines(t->line <= srcLineCount(&source) ? t->line : srcLineCount(&source));
+    if (TraceScan)
+    {
+        fprintf(listing, "\t%d: ", t->line);
+        printToken((TokenType)t->kind, source.buf + t->start, t->len);
+    }
+}
+
+int scanDirective(ScanState* ss, int* nameStart, int* nameLen)
+{
+    const char* b = ss->buf;
+    int p = ss->pos;
+    int q;
+
+    /* buf[len] == '\0' 이므로 공백 건너뛰기는 끝에서 멈춘다 */
+    while (b[p] == ' ' || b[p] == '\t') p++;
+    if (p + 7 > ss->len || memcmp(b + p, "include", 7) != 0) return FALSE;
+    p += 7;
+    while (b[p] == ' ' || b[p] == '\t') p++;
+    if (b[p] != '"') return FALSE;
+    q = ++p;
+    while (q < ss->len && b[q] != '"' && b[q] != '\n') q++;
+    if (q >= ss->len || b[q] != '"' || q == p) return FALSE;
+
+    *nameStart = p;
+    *nameLen = q - p;
+    ss->pos = q + 1;
+    ss->last = q;
+    return TRUE;
+}
+
+void lexHeader(SourceFile* sf, int file, TokenArray* ta)
+{
+    ScanState ss;
+    Token t;
+    int start, len;
+
+    scanInit(&ss, sf->buf, sf->len);
+    for (;;)
+    {
+        t.kind = (short)scanNext(&ss);
+        if (t.kind == ENDFILE) break;
+        t.start = ss.start;
+        t.len = ss.pos - ss.start;
+        if (t.kind == ERROR && sf->buf[t.start] == '#' && scanDirective(&ss, &start, &len))
+        {
+            t.kind = INCLUDE;
+            t.start = start;
+            t.len = len;
+        }
+        t.file = (short)file;
+        t.line = srcLineOf(sf, ss.last);
+        if (t.kind == NUM)
+            t.val = numberValue(sf->buf + t.start, t.len);
+        else if (t.kind == ID)
+            t.val = internName(sf->buf + t.start, t.len);
+        else
+            t.val = 0;
+        pushToken(ta, &t);
+    }
+}
+
+/* lexAll / lexStream 이 토큰을 내보내는 곳 */
+typedef struct {
+    TokenArray* ta;     /* lexAll: 배열에 바로 */
+    SpscQueue* out;     /* lexStream: TOKBLOCK 개씩 묶어 큐로 */
+    TokenBlock* block;
+} TokenSink;
+
+static void emitToken(TokenSink* sk, const Token* t)
+{
+    TokenBlock* b = sk->block;
+
+    if (sk->out == NULL)
+    {
+        pushToken(sk->ta, t);
+        return;
+    }
+    if (b == NULL)
+    {
+        b = sk->block = (TokenBlock*)malloc(sizeof(TokenBlock));
+        if (b == NULL)
+        {
+            fprintf(stderr, "Error: Out of memory for token block\n");
+            exit(1);
+        }
+        b->count = 0;
+    }
+    b->tok[b->count++] = *t;
+    /* 보낸 블록은 파서가 해제한다 */
+    if (b->count == TOKBLOCK || t->kind == ENDFILE)
+    {
+        sk->block = NULL;
+        queuePush(sk->out, b);
+    }
+}
+
+/* #include 자리에 헤더의 토큰을 펼친다 (중첩 #include 포함).
+ * 펼친 토큰의 줄은 소스의 #include 줄 line 으로 바꾼다: 헤더 안의 오류도 소스의 줄로 보고된다.
+ * 이미 포함한 헤더는 건너뛰고, 열 수 없으면 Error 를 세우고 알린 뒤 그 자리를 비운다 */
+static void expandInclude(TokenSink* sk, const Token* inc, int line)
+{
+    int once;
+    const Header* h = includeHeader(inc->file, tokText(inc), inc->len, &once);
+
+    if (h == NULL)
+    {
+        if (!once)
+        {
+            fprintf(listing, "Include error at line %d: cannot open \"%.*s\"\n",
+                line, inc->len, tokText(inc));
+            Error = TRUE;
+        }
+        return;
+    }
+    for (int i = 0; i < h->count; i++)
+    {
+        Token t = h->tok[i];
+        if (TraceScan)
+        {
+            fprintf(listing, "\t%d: ", t.line);
+            printToken((TokenType)t.kind, tokText(&t), t.len);
+        }
+        if (t.kind == INCLUDE)
+            expandInclude(sk, &t, line);
+        else
+        {
+            t.line = line;
+            emitToken(sk, &t);
+        }
+    }
+}
+
+/* 다음 토큰 하나를 Token 으로 */
+static void readToken(Token* t)
+{
+    t->kind = (short)getToken();
+    t->file = 0;
+    t->line = lineno;
+    t->start = tokenStart;
+    t->len = tokenLen;
+    /* NUM 은 값, ID 는 이름의 atom */
+    if (t->kind == NUM)
+        t->val = tokenNumber();
+    else if (t->kind == ID)
+        t->val = internName(tokenText, tokenLen);
+    else
+        t->val = 0;
+}
+
+/* source 를 처음부터 끝까지 읽어 sk 로 내보낸다 (#include 는 펼침) */
+static void lexSource(TokenSink* sk)
+{
+    Token t;
+
+    /* 항상 source 의 처음부터 */
+    scanInit(&scanner, source.buf, source.len);
+    echoSrc = NULL;
+    includeReset();
+    do
+    {
+        readToken(&t);
+        if (t.kind == INCLUDE)
+            expandInclude(sk, &t, t.line);
+        else
+            emitToken(sk, &t);
+    } while (t.kind != ENDFILE);
+}
+
+/* 어휘 분석 선행 패스: 파서는 이 배열의 인덱스로 토큰을 읽는다 */
+void lexAll(TokenArray* ta)
+{
+    TokenSink sk;
+
+    ta->tok = NULL;
+    ta->count = 0;
+    ta->cap = 0;
+    sk.ta = ta;
+    sk.out = NULL;
+    sk.block = NULL;
+    lexSource(&sk);
+}
+
+void lexStream(SpscQueue* out)
+{
+    TokenSink sk;
+
+    sk.ta = NULL;
+    sk.out = out;
+    sk.block = NULL;
+    lexSource(&sk);
+}
+
+void freeTokens(TokenArray* ta)
+{
+    free(ta->tok);
+    ta->tok = NULL;
+    ta->count = 0;
+    ta->cap = 0;
+}
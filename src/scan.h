@@ -6,10 +6,85 @@
 #ifndef _SCAN_H_
 #define _SCAN_H_
 
-#define MAXTOKENLEN 40
 #include "globals.h"
-extern char tokenString[MAXTOKENLEN + 1];
+#include "source.h"
+#include "thread.h"
 
+/* 현재 토큰의 lexeme: 소스 버퍼 안의 (오프셋, 길이) 조각 (복사 없음) */
+extern int tokenStart;
+extern int tokenLen;
+#define tokenText (source.buf + tokenStart)
+
+/* 재진입 가능한 스캐너 상태: 버퍼 하나를 처음부터 끝까지 훑는다 */
+typedef struct {
+    const char* buf;  /* buf[len] == '\0' 이어야 함 */
+    int len;
+    int pos;          /* 다음에 읽을 위치 */
+    int start;        /* 방금 인식한 토큰의 시작 */
+    int last;         /* 마지막으로 들여다본 문자 위치 (EOF 면 len) */
+} ScanState;
+
+/* 공유 표(문자 종류, 전이표, 예약어 해시)와 SIMD 커널을 한 번 만든다.
+ * scanInit 도 부르지만, 여러 스레드가 스캔할 때는 시작 전에 한 스레드에서 불러
+ * 작업자는 표를 읽기만 하게 한다 */
+void initScanTables(void);
+void scanInit(ScanState* ss, const char* buf, int len);
+
+/* 토큰 하나를 인식해 돌려준다: lexeme 은 buf[start .. pos) */
+TokenType scanNext(ScanState* ss);
+
+/* 기존 switch 기반 DFA (결과는 scanNext 와 같음, 벤치마크 비교용) */
+TokenType scanNextSwitch(ScanState* ss);
+
+/* source 에서 다음 토큰을 읽는다 (lineno, 에코/트레이스 처리 포함) */
 TokenType getToken(void);
 
+/* 현재 NUM 토큰의 값 */
+int tokenNumber(void);
+int numberValue(const char* s, int len);
+
+/* 미리 읽어 둔 토큰 하나: 종류, 소스 조각, 줄 번호, NUM 값 */
+typedef struct {
+    short kind;       /* TokenType */
+    short file;       /* 0: source, 그 밖: #include 한 헤더 (include.h) */
+    int line;         /* 줄 번호 (헤더 캐시 안에서는 헤더의 줄, 펼친 뒤에는 소스의 #include 줄) */
+    int start;        /* 그 파일 버퍼 안의 오프셋 */
+    int len;
+    int val;          /* NUM: 값, ID: 이름의 atom */
+} Token;
+
+/* 연속된 토큰 배열 (마지막은 항상 ENDFILE) */
+typedef struct {
+    Token* tok;
+    int count;
+    int cap;
+} TokenArray;
+
+/* source 전체를 한 번에 토큰 배열로 만든다 (에코/트레이스 출력 포함) */
+void lexAll(TokenArray* ta);
+void freeTokens(TokenArray* ta);
+void pushToken(TokenArray* ta, const Token* t);
+
+/* 파이프라인용: 토큰을 TOKBLOCK 개씩 묶어 큐로 보낸다 (받은 쪽이 free).
+ * 마지막 블록은 ENDFILE 로 끝난다 */
+#define TOKBLOCK 4096
+
+typedef struct {
+    int count;
+    Token tok[TOKBLOCK];
+} TokenBlock;
+
+void lexStream(SpscQueue* out);
+
+/* 이미 만든 토큰의 에코/트레이스 출력 (getToken 과 같은 형식) */
+void listToken(const Token* t);
+
+/* '#' 바로 뒤에서 include "파일" 을 인식한다 (한 줄 안).
+ * 맞으면 파일 이름 조각을 돌려주고 ss 를 닫는 따옴표 뒤로 옮긴다 */
+int scanDirective(ScanState* ss, int* nameStart, int* nameLen);
+
+/* 헤더 버퍼 하나를 출력 없이 토큰 배열로 (ENDFILE 은 넣지 않음).
+ * 토큰의 file 은 file, 중첩 #include 는 INCLUDE 토큰으로 남긴다 */
+void lexHeader(SourceFile* sf, int file, TokenArray* ta);
+
 #endif
@@ -0,0 +1,274 @@
+/****************************************************/
+/* File: scansimd.c                                 */
+/* SIMD fast paths for the C- scanner               */
+/****************************************************/
+
+#include "globals.h"
+#include "scansimd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+ScanKernels scanKernels;
+static int currentLevel = -1;
+
+/* -------------------------------------------------- */
+/* 스칼라 커널 (어느 환경에서나 동작, 결과 기준)      */
+/* -------------------------------------------------- */
+
+static int isSpaceByte(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int isDigitByte(int c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static int isIdentByte(int c)
+{
+    return isDigitByte(c) || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+}
+
+static int spacesScalar(const char* buf, int pos, int len)
+{
+    while (pos < len && isSpaceByte((unsigned char)buf[pos]))
+        pos++;
+    return pos;
+}
+
+static int identScalar(const char* buf, int pos, int len)
+{
+    while (pos < len && isIdentByte((unsigned char)buf[pos]))
+        pos++;
+    return pos;
+}
+
+static int digitsScalar(const char* buf, int pos, int len)
+{
+    while (pos < len && isDigitByte((unsigned char)buf[pos]))
+        pos++;
+    return pos;
+}
+
+static int commentEndScalar(const char* buf, int pos, int len)
+{
+    while (pos + 1 < len) {
+        const char* p = (const char*)memchr(buf + pos, '*', (size_t)(len - pos - 1));
+        if (p == NULL)
+            break;
+        pos = (int)(p - buf);
+        if (buf[pos + 1] == '/')
+            return pos + 2;
+        pos++;
+    }
+    return -1;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/* -------------------------------------------------- */
+/* SSE2 커널: 16 바이트씩                              */
+/* -------------------------------------------------- */
+
+/* 부호 있는 비교로 [lo, lo+n) 범위 검사: c - lo - 128 < -128 + n */
+#define RANGE16(v, lo, n) \
+    _mm_cmplt_epi8(_mm_add_epi8((v), _mm_set1_epi8((char)(128 - (lo)))), \
+                   _mm_set1_epi8((char)(-128 + (n))))
+
+__attribute__((target("sse2")))
+static int spacesSSE2(const char* buf, int pos, int len)
+{
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(buf + pos));
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        unsigned int bits = ~(unsigned int)_mm_movemask_epi8(m) & 0xffffu;
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 16;
+    }
+    return spacesScalar(buf, pos, len);
+}
+
+__attribute__((target("sse2")))
+static int identSSE2(const char* buf, int pos, int len)
+{
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(buf + pos));
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i m = _mm_or_si128(RANGE16(lower, 'a', 26), RANGE16(v, '0', 10));
+        unsigned int bits = ~(unsigned int)_mm_movemask_epi8(m) & 0xffffu;
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 16;
+    }
+    return identScalar(buf, pos, len);
+}
+
+__attribute__((target("sse2")))
+static int digitsSSE2(const char* buf, int pos, int len)
+{
+    while (pos + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(buf + pos));
+        unsigned int bits = ~(unsigned int)_mm_movemask_epi8(RANGE16(v, '0', 10)) & 0xffffu;
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 16;
+    }
+    return digitsScalar(buf, pos, len);
+}
+
+__attribute__((target("sse2")))
+static int commentEndSSE2(const char* buf, int pos, int len)
+{
+    /* buf[i] == '*' 이고 buf[i+1] == '/' 인 i 를 찾는다 */
+    while (pos + 17 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(buf + pos));
+        __m128i b = _mm_loadu_si128((const __m128i*)(buf + pos + 1));
+        __m128i m = _mm_and_si128(_mm_cmpeq_epi8(a, _mm_set1_epi8('*')),
+                                  _mm_cmpeq_epi8(b, _mm_set1_epi8('/')));
+        unsigned int bits = (unsigned int)_mm_movemask_epi8(m);
+        if (bits != 0)
+            return pos + __builtin_ctz(bits) + 2;
+        pos += 16;
+    }
+    return commentEndScalar(buf, pos, len);
+}
+
+/* -------------------------------------------------- */
+/* AVX2 커널: 32 바이트씩                              */
+/* -------------------------------------------------- */
+
+#define RANGE32(v, lo, n) \
+    _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + (n))), \
+                      _mm256_add_epi8((v), _mm256_set1_epi8((char)(128 - (lo)))))
+
+__attribute__((target("avx2")))
+static int spacesAVX2(const char* buf, int pos, int len)
+{
+    while (pos + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(buf + pos));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        unsigned int bits = ~(unsigned int)_mm256_movemask_epi8(m);
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 32;
+    }
+    return spacesSSE2(buf, pos, len);
+}
+
+__attribute__((target("avx2")))
+static int identAVX2(const char* buf, int pos, int len)
+{
+    while (pos + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(buf + pos));
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i m = _mm256_or_si256(RANGE32(lower, 'a', 26), RANGE32(v, '0', 10));
+        unsigned int bits = ~(unsigned int)_mm256_movemask_epi8(m);
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 32;
+    }
+    return identSSE2(buf, pos, len);
+}
+
+__attribute__((target("avx2")))
+static int digitsAVX2(const char* buf, int pos, int len)
+{
+    while (pos + 32 <= len) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(buf + pos));
+        unsigned int bits = ~(unsigned int)_mm256_movemask_epi8(RANGE32(v, '0', 10));
+        if (bits != 0)
+            return pos + __builtin_ctz(bits);
+        pos += 32;
+    }
+    return digitsSSE2(buf, pos, len);
+}
+
+__attribute__((target("avx2")))
+static int commentEndAVX2(const char* buf, int pos, int len)
+{
+    while (pos + 33 <= len) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(buf + pos));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(buf + pos + 1));
+        __m256i m = _mm256_and_si256(_mm256_cmpeq_epi8(a, _mm256_set1_epi8('*')),
+                                     _mm256_cmpeq_epi8(b, _mm256_set1_epi8('/')));
+        unsigned int bits = (unsigned int)_mm256_movemask_epi8(m);
+        if (bits != 0)
+            return pos + __builtin_ctz(bits) + 2;
+        pos += 32;
+    }
+    return commentEndSSE2(buf, pos, len);
+}
+
+#endif /* HAVE_X86_SIMD */
+
+int scanSimdBest(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+int setScanSimd(int level)
+{
+    if (level < SIMD_SCALAR || level > scanSimdBest())
+        return FALSE;
+
+    switch (level) {
+#ifdef HAVE_X86_SIMD
+    case SIMD_AVX2:
+        scanKernels.spaces = spacesAVX2;
+        scanKernels.ident = identAVX2;
+        scanKernels.digits = digitsAVX2;
+        scanKernels.commentEnd = commentEndAVX2;
+        break;
+    case SIMD_SSE2:
+        scanKernels.spaces = spacesSSE2;
+        scanKernels.ident = identSSE2;
+        scanKernels.digits = digitsSSE2;
+        scanKernels.commentEnd = commentEndSSE2;
+        break;
+#endif
+    default:
+        scanKernels.spaces = spacesScalar;
+        scanKernels.ident = identScalar;
+        scanKernels.digits = digitsScalar;
+        scanKernels.commentEnd = commentEndScalar;
+        break;
+    }
+    currentLevel = level;
+    return TRUE;
+}
+
+void initScanSimd(void)
+{
+    if (currentLevel < 0)
+        setScanSimd(scanSimdBest());
+}
+
+int scanSimdLevel(void)
+{
+    return currentLevel;
+}
+
+const char* scanSimdName(int level)
+{
+    switch (level) {
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_SSE2: return "SSE2";
+    default:        return "scalar";
+    }
+}
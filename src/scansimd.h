@@ -0,0 +1,37 @@
+/****************************************************/
+/* File: scansimd.h                                 */
+/* SIMD fast paths for the C- scanner               */
+/****************************************************/
+
+#ifndef _SCANSIMD_H_
+#define _SCANSIMD_H_
+
+/* 사용할 커널 수준 */
+#define SIMD_SCALAR 0
+#define SIMD_SSE2   1
+#define SIMD_AVX2   2
+
+/* 긴 구간을 한 번에 건너뛰는 커널들.
+ * 모두 buf[pos] 부터 조건을 만족하는 문자가 끝나는 위치를 돌려준다 (최대 len) */
+typedef struct {
+    int (*spaces)(const char* buf, int pos, int len);  /* ' ' '\t' '\n' '\r' */
+    int (*ident)(const char* buf, int pos, int len);   /* 영문자, 숫자 */
+    int (*digits)(const char* buf, int pos, int len);  /* 숫자 */
+    /* 다음 "*" "/" 바로 뒤 위치, 없으면 -1 */
+    int (*commentEnd)(const char* buf, int pos, int len);
+} ScanKernels;
+
+extern ScanKernels scanKernels;
+
+/* CPUID 로 쓸 수 있는 최고 수준을 골라 scanKernels 를 채운다 */
+void initScanSimd(void);
+
+/* 커널 수준을 강제로 지정 (지원하지 않으면 FALSE). 벤치마크/검증용 */
+int setScanSimd(int level);
+
+/* 현재 수준, 지원되는 최고 수준, 이름 */
+int scanSimdLevel(void);
+int scanSimdBest(void);
+const char* scanSimdName(int level);
+
+#endif
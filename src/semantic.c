@@ -2,41 +2,38 @@
 #include "symtab.h"
 #include "parse.h"
 #include "semantic.h"
+#include "intern.h"
+#include "visit.h"
+#include "thread.h"
+#include "arena.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* 메모리 위치 카운터 (스코프별) */
-static int location[100];
+/* 현재 처리 중인 함수의 반환 타입 (Return 문 검사용, 스레드마다) */
+static THREAD_LOCAL ExpType currentFunctionType = Void;
 
-/* 현재 처리 중인 함수의 반환 타입 (Return 문 검사용) */
-static ExpType currentFunctionType = Void;
+/* -fused: 파싱하면서 낸 진단은 따로 모아 두었다가 구문 오류가 없을 때만 출력.
+ * Error 는 파서의 구문 오류 표시로 남겨 둔다 */
+static FILE* fusedOut = NULL;
+static int fusedError = FALSE;
 
 /* 에러 출력 헬퍼 */
 static void typeError(TreeNode* t, char* message)
 {
+    if (fusedOut != NULL) {
+        fprintf(fusedOut, "Semantic Error at line %d: %s\n", t->lineno, message);
+        fusedError = TRUE;
+        return;
+    }
     fprintf(listing, "Semantic Error at line %d: %s\n", t->lineno, message);
     Error = TRUE;
 }
 
-/* AST 순회 함수: preProc → 자식들 → postProc → sibling */
-static void traverse(TreeNode* t,
-    void (*preProc)(TreeNode*),
-    void (*postProc)(TreeNode*))
+/* 구문 오류로 비어 있는 피연산자는 void 로 본다 */
+static ExpType typeOf(TreeNode* t)
 {
-    if (t != NULL)
-    {
-        if (preProc != NULL)
-            preProc(t);
-
-        for (int i = 0; i < MAXCHILDREN; i++)
-            traverse(t->child[i], preProc, postProc);
-
-        if (postProc != NULL)
-            postProc(t);
-
-        traverse(t->sibling, preProc, postProc);
-    }
+    return t == NULL ? Void : t->type;
 }
 
 /* =================================================== */
@@ -48,7 +45,7 @@ static void insertNode(TreeNode* t)
     {
     case DeclK:
     {
-        char* name = t->attr.name;
+        int name = t->attr.atom;
         ExpType type = t->type;
 
         /* 함수 선언 시: 반환 타입 추적 시작 */
@@ -62,14 +59,14 @@ static void insertNode(TreeNode* t)
             break;
         }
 
-        /* 심볼 테이블 삽입 */
-        int loc = location[currentScope]++;
-        st_insert(name, type, loc, currentScope, t);
+        /* 심볼 테이블 삽입: 선언 노드는 자기 항목을 가리킨다 */
+        int loc = st_next_loc(currentScope);
+        t->sym = st_insert(name, type, loc, currentScope, t);
 
         /* FunK: 함수 몸체로 들어가기 전에 스코프 증가 */
         if (t->kind.decl == FunK) {
             currentScope++;
-            location[currentScope] = 0;
+            st_enter_scope(currentScope);
         }
     }
     break;
@@ -78,7 +75,7 @@ static void insertNode(TreeNode* t)
         /* CmpdK: 복합 문장 '{ ... }' 진입 시 스코프 증가 */
         if (t->kind.stmt == CmpdK) {
             currentScope++;
-            location[currentScope] = 0;
+            st_enter_scope(currentScope);
         }
         break;
 
@@ -106,31 +103,32 @@ static void checkNode(TreeNode* t)
                 if (t->child[0]->kind.exp != IdK) {
                     typeError(t, "Assignment target must be a simple variable.");
                 }
-                else if (t->child[0]->type != t->child[1]->type) {
+                else if (typeOf(t->child[0]) != typeOf(t->child[1])) {
                     typeError(t, "Type mismatch in assignment.");
                 }
-                t->type = t->child[0]->type;
+                t->type = typeOf(t->child[0]);
             }
             else if (t->attr.op >= LT && t->attr.op <= NEQ) { /* 비교 연산 */
-                if (t->child[0]->type != Integer || t->child[1]->type != Integer)
+                if (typeOf(t->child[0]) != Integer || typeOf(t->child[1]) != Integer)
                     typeError(t, "Operands must be 'int' for comparison.");
                 t->type = Integer;
             }
             else { /* 산술 연산 (+, -, *, /) */
-                if (t->child[0]->type != Integer || t->child[1]->type != Integer)
+                if (typeOf(t->child[0]) != Integer || typeOf(t->child[1]) != Integer)
                     typeError(t, "Operands must be 'int' for arithmetic operation.");
                 t->type = Integer;
             }
             break;
 
         case IdK:
-            l = st_lookup(t->attr.name);
+            l = st_lookup(t->attr.atom);
             if (l == NULL) {
                 typeError(t, "Undeclared variable used.");
                 t->type = Void;
             }
             else {
                 t->type = l->type;
+                t->sym = l;   /* 이후 단계는 이름 대신 이 항목으로 */
             }
             break;
 
@@ -139,17 +137,14 @@ static void checkNode(TreeNode* t)
              * - input()  : int 반환
              * - output() : void 반환
              */
-            if (strcmp(t->attr.name, "input") == 0) {
-                t->type = Integer;
-                break;
-            }
-            if (strcmp(t->attr.name, "output") == 0) {
-                t->type = Void;
+            if (t->attr.atom == ATOM_INPUT || t->attr.atom == ATOM_OUTPUT) {
+                t->sym = st_builtin(t->attr.atom);
+                t->type = t->sym->type;
                 break;
             }
 
             /* 나머지 함수는 심볼테이블에서 찾는다 */
-            l = st_lookup(t->attr.name);
+            l = st_lookup(t->attr.atom);
             if (l == NULL) {
                 typeError(t, "Undeclared function called.");
                 t->type = Void;  /* 안전한 기본값 */
@@ -163,6 +158,7 @@ static void checkNode(TreeNode* t)
                 else {
                     /* 함수의 반환 타입을 호출 노드에 반영 */
                     t->type = l->type;
+                    t->sym = l;
                 }
             }
             break;
@@ -219,20 +215,237 @@ static void checkNode(TreeNode* t)
     }
 }
 
-/* 최종 의미 분석 메인 함수 */
-void analyze(TreeNode* syntaxTree)
+/* AST 순회: insertNode → 자식들 → checkNode → sibling (visit.h, 비재귀) */
+#define SEM_PRE(ctx, t, p, slot, d)  (insertNode(t), VISIT_ALL)
+#define SEM_POST(ctx, t, p, slot)    checkNode(t)
+DEFINE_TREE_VISITOR(traverse, void, SEM_PRE, VISIT_NOMID, VISIT_NOSIB, SEM_POST)
+
+/* 분석 시작: 전역 스코프에서 */
+void analyzeBegin(void)
 {
     currentScope = 0;
-    location[0] = 0;
+    st_enter_scope(0);
 
     if (TraceParse)
         fprintf(listing, "\nBuilding Symbol Table & Checking Types...\n");
+}
 
-    /* insertNode(Pre): 선언 등록, 스코프 진입
-       checkNode(Post): 타입 검사, 스코프 탈출 */
-    traverse(syntaxTree, insertNode, checkNode);
+/* 최상위 선언 하나 (decl->sibling 은 NULL 이어야 한다) */
+void analyzeDecl(TreeNode* decl)
+{
+    traverse(NULL, decl);
+}
 
+void analyzeEnd(void)
+{
     if (!Error) {
         fprintf(listing, "\nSemantic analysis completed successfully.\n");
     }
 }
+
+void semEnter(TreeNode* t)
+{
+    insertNode(t);
+}
+
+void semLeave(TreeNode* t)
+{
+    checkNode(t);
+}
+
+int fusedBegin(void)
+{
+    fusedOut = tmpfile();
+    if (fusedOut == NULL) return FALSE;
+    fusedError = FALSE;
+    currentScope = 0;
+    st_enter_scope(0);
+
+    if (TraceParse)
+        fprintf(fusedOut, "\nBuilding Symbol Table & Checking Types...\n");
+    return TRUE;
+}
+
+void fusedFinish(int emit)
+{
+    char buf[8192];
+    size_t n;
+
+    if (emit) {
+        if (!fusedError)
+            fprintf(fusedOut, "\nSemantic analysis completed successfully.\n");
+        rewind(fusedOut);
+        while ((n = fread(buf, 1, sizeof(buf), fusedOut)) > 0)
+            fwrite(buf, 1, n, listing);
+        if (fusedError) Error = TRUE;
+    }
+    fclose(fusedOut);
+    fusedOut = NULL;
+}
+
+/* =================================================== */
+/* 병렬 분석 (-sem-threads): 1단계에서 전역 선언을 모두 등록해      */
+/* 읽기 전용으로 고정하고, 2단계에서 함수 몸체를 동시에 검사한다    */
+/* =================================================== */
+typedef struct {
+    TreeNode** funcs;   /* 함수 선언 (소스 순서) */
+    int nfuncs;
+    atomic_int next;    /* 다음에 가져갈 함수 */
+    int* owner;         /* 함수 i 를 검사한 작업자 */
+    long* begin;        /* 함수 i 의 진단: out[owner[i]] 의 [begin, end) */
+    long* end;
+    FILE** out;         /* 작업자별 진단 */
+    Arena* arena;       /* 작업자별 심볼 항목 */
+    int* error;
+} SemJob;
+
+/* 전역 함수 f 의 몸체: 순차 분석에서 insertNode(f) 가 등록을 마친 뒤와 같은 상태에서.
+ * 전역은 f 와 그 앞에 선언된 것만 보인다 */
+static void analyzeFunction(TreeNode* f)
+{
+    st_use_globals(f->sym->memloc);
+    currentFunctionType = f->type;
+    currentScope = 1;
+    st_enter_scope(1);
+    for (int k = 0; k < MAXCHILDREN; k++)
+        traverse(NULL, f->child[k]);
+    checkNode(f);   /* 스코프 탈출 */
+}
+
+static void semWorker(void* arg, int k)
+{
+    SemJob* job = (SemJob*)arg;
+    int i;
+
+    listing = job->out[k];
+    curArena = &job->arena[k];
+    Error = FALSE;
+    initSymTab();
+    while ((i = atomic_fetch_add(&job->next, 1)) < job->nfuncs) {
+        job->owner[i] = k;
+        job->begin[i] = ftell(listing);
+        analyzeFunction(job->funcs[i]);
+        job->end[i] = ftell(listing);
+    }
+    job->error[k] = Error;
+    freeSymTab();
+}
+
+/* f 의 [begin, end) 를 listing 으로 */
+static void copyRange(FILE* f, long begin, long end)
+{
+    char buf[8192];
+    size_t n;
+
+    fseek(f, begin, SEEK_SET);
+    while (begin < end && (n = fread(buf, 1, (size_t)(end - begin < (long)sizeof(buf) ? end - begin : (long)sizeof(buf)), f)) > 0) {
+        fwrite(buf, 1, n, listing);
+        begin += (long)n;
+    }
+}
+
+/* 1단계: 전역 선언을 순서대로 등록. 재선언이 있으면 (순차 분석은 그 뒤 스코프가
+ * 어긋난 채로 진행하므로) 되돌리고 FALSE */
+static int registerGlobals(TreeNode* tree, TreeNode** funcs)
+{
+    int n = 0;
+
+    for (TreeNode* t = tree; t != NULL; t = t->sibling) {
+        if (st_lookup_scope(t->attr.atom, 0) != NULL) {
+            st_delete_scope(0);
+            st_enter_scope(0);
+            for (TreeNode* u = tree; u != t; u = u->sibling)
+                u->sym = NULL;
+            return FALSE;
+        }
+        t->sym = st_insert(t->attr.atom, t->type, st_next_loc(0), 0, t);
+        if (t->kind.decl == FunK) funcs[n++] = t;
+    }
+    return TRUE;
+}
+
+/* 진단은 함수 순서(= 소스 줄 순서)로 이어 붙이므로 순차 분석과 같다.
+ * 나눌 함수가 없거나 준비에 실패하면 FALSE (순차 분석으로) */
+static int analyzeParallel(TreeNode* tree, int nthreads)
+{
+    SemJob job;
+    FILE* savedListing = listing;
+    Arena* savedArena = curArena;
+    int savedError = Error;
+    int ndecls = 0, nfuncs = 0, n, k, ok = TRUE;
+
+    for (TreeNode* t = tree; t != NULL; t = t->sibling) {
+        if (t->nodekind != DeclK) return FALSE;
+        ndecls++;
+        if (t->kind.decl == FunK) nfuncs++;
+    }
+    if (nthreads <= 0) nthreads = cpuCount();
+    n = nfuncs < nthreads ? nfuncs : nthreads;
+    if (n <= 1) return FALSE;
+
+    memset(&job, 0, sizeof(job));
+    job.funcs = (TreeNode**)malloc(sizeof(TreeNode*) * ndecls);
+    job.owner = (int*)malloc(sizeof(int) * nfuncs);
+    job.begin = (long*)malloc(sizeof(long) * nfuncs);
+    job.end = (long*)malloc(sizeof(long) * nfuncs);
+    job.out = (FILE**)calloc((size_t)n, sizeof(FILE*));
+    job.arena = (Arena*)calloc((size_t)n, sizeof(Arena));
+    job.error = (int*)calloc((size_t)n, sizeof(int));
+    if (job.funcs == NULL || job.owner == NULL || job.begin == NULL || job.end == NULL ||
+        job.out == NULL || job.arena == NULL || job.error == NULL) {
+        fprintf(stderr, "Error: Out of memory in semantic analysis\n");
+        exit(1);
+    }
+    for (k = 0; k < n && ok; k++) {
+        job.out[k] = tmpfile();
+        ok = job.out[k] != NULL;
+        arenaInit(&job.arena[k], ARENA_BLOCK);
+    }
+
+    if (ok) ok = registerGlobals(tree, job.funcs);
+    if (ok) {
+        job.nfuncs = nfuncs;
+        atomic_init(&job.next, 0);
+
+        /* 2단계: 0 번 작업자는 이 스레드에서 돈다. 스레드별 상태를 되돌린다 */
+        st_freeze_globals();
+        runParallel(n, semWorker, &job);
+        st_thaw_globals();
+        listing = savedListing;
+        curArena = savedArena;
+        Error = savedError;
+        currentScope = 0;
+
+        for (int i = 0; i < nfuncs; i++)
+            copyRange(job.out[job.owner[i]], job.begin[i], job.end[i]);
+        for (k = 0; k < n; k++)
+            Error = Error || job.error[k];
+    }
+
+    for (k = 0; k < n; k++) {
+        if (job.out[k] != NULL) fclose(job.out[k]);
+        /* 작업자가 만든 심볼 항목은 노드가 가리키므로 이번 컴파일의 arena 로 */
+        arenaMerge(curArena, &job.arena[k]);
+    }
+    free(job.funcs);
+    free(job.owner);
+    free(job.begin);
+    free(job.end);
+    free(job.out);
+    free(job.arena);
+    free(job.error);
+    return ok;
+}
+
+/* 최종 의미 분석 메인 함수 */
+void analyze(TreeNode* syntaxTree)
+{
+    analyzeBegin();
+
+    /* insertNode(Pre): 선언 등록, 스코프 진입
+       checkNode(Post): 타입 검사, 스코프 탈출 */
+    if (SemThreads == 1 || !analyzeParallel(syntaxTree, SemThreads))
+        traverse(NULL, syntaxTree);
+
+    analyzeEnd();
+}
@@ -7,4 +7,17 @@
 // AST를 두 단계로 순회하여 의미 분석을 수행하는 메인 함수
 void analyze(TreeNode *syntaxTree);
 
+// 파이프라인 모드: 최상위 선언을 하나씩 (analyzeBegin → analyzeDecl ... → analyzeEnd)
+void analyzeBegin(void);
+void analyzeDecl(TreeNode *decl);
+void analyzeEnd(void);
+
+// -fused: 파서가 노드를 만들면서 부른다. semEnter 는 노드를 만들 때(선언 등록,
+// 스코프 진입), semLeave 는 자식까지 다 만든 뒤(타입 검사, 스코프 탈출).
+// 두 번 순회하는 analyze() 와 같은 순서(전위 / 후위)로 불러야 진단이 같다
+int fusedBegin(void);           // 진단 모으기 시작 (실패하면 FALSE)
+void semEnter(TreeNode *t);
+void semLeave(TreeNode *t);
+void fusedFinish(int emit);     // emit: 모은 진단을 listing 으로 (구문 오류가 없을 때)
+
 #endif
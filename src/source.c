@@ -0,0 +1,249 @@
+/****************************************************/
+/* File: source.c                                   */
+/* Memory-mapped source input for the C- scanner    */
+/****************************************************/
+
+#include "globals.h"
+#include "source.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char emptyBuf[1] = { '\0' };
+
+/* 매핑 없이 파일을 통째로 읽어 '\0' 으로 끝나는 heap 버퍼를 만든다 */
+static int readWhole(SourceFile* sf, const char* fname)
+{
+    FILE* fp = fopen(fname, "rb");
+    char* buf;
+    long n;
+
+    if (fp == NULL) return FALSE;
+    fseek(fp, 0, SEEK_END);
+    n = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (n < 0) {
+        fclose(fp);
+        return FALSE;
+    }
+    buf = (char*)malloc((size_t)n + 1);
+    if (buf == NULL) {
+        fclose(fp);
+        return FALSE;
+    }
+    n = (long)fread(buf, 1, (size_t)n, fp);
+    buf[n] = '\0';
+    fclose(fp);
+
+    sf->buf = buf;
+    sf->len = (int)n;
+    sf->mapped = FALSE;
+    return TRUE;
+}
+
+#ifdef _WIN32
+static int mapWhole(SourceFile* sf, const char* fname)
+{
+    HANDLE f, m;
+    LARGE_INTEGER size;
+    SYSTEM_INFO si;
+    void* p;
+
+    f = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) return FALSE;
+    GetSystemInfo(&si);
+    /* 크기가 페이지 배수이면 끝의 '\0' 보초가 없으므로 매핑하지 않는다 */
+    if (!GetFileSizeEx(f, &size) || size.QuadPart == 0 ||
+        size.QuadPart > 0x7ffffffe || size.QuadPart % si.dwPageSize == 0) {
+        CloseHandle(f);
+        return FALSE;
+    }
+    m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(f);
+    if (m == NULL) return FALSE;
+    p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(m);
+    if (p == NULL) return FALSE;
+
+    sf->buf = (const char*)p;
+    sf->len = (int)size.QuadPart;
+    sf->mapped = TRUE;
+    return TRUE;
+}
+#else
+static int mapWhole(SourceFile* sf, const char* fname)
+{
+    struct stat st;
+    long page = sysconf(_SC_PAGESIZE);
+    void* p;
+    int fd = open(fname, O_RDONLY);
+
+    if (fd < 0) return FALSE;
+    /* 마지막 페이지의 남는 부분은 0 으로 채워지므로 buf[len] == '\0' 이 된다.
+     * 크기가 페이지 배수이면 보초 자리가 없으므로 매핑하지 않는다 */
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 ||
+        st.st_size > 0x7ffffffe || page <= 0 || st.st_size % page == 0) {
+        close(fd);
+        return FALSE;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return FALSE;
+#ifdef MADV_SEQUENTIAL
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+
+    sf->buf = (const char*)p;
+    sf->len = (int)st.st_size;
+    sf->mapped = TRUE;
+    return TRUE;
+}
+#endif
+
+static void initLines(SourceFile* sf)
+{
+    sf->lineStart = NULL;
+    sf->nlines = 0;
+    sf->lineCap = 0;
+    sf->scanned = 0;
+    sf->lastLine = 0;
+}
+
+int openSource(SourceFile* sf, const char* fname)
+{
+    initLines(sf);
+    if (mapWhole(sf, fname)) return TRUE;
+    if (!readWhole(sf, fname)) return FALSE;
+    if (sf->len == 0) {
+        free((char*)sf->buf);
+        sf->buf = emptyBuf;
+    }
+    return TRUE;
+}
+
+int openSourceMemory(SourceFile* sf, const char* text, int len)
+{
+    char* buf = (char*)malloc((size_t)len + 1);
+    if (buf == NULL) return FALSE;
+    memcpy(buf, text, (size_t)len);
+    buf[len] = '\0';
+    initLines(sf);
+    sf->buf = buf;
+    sf->len = len;
+    sf->mapped = FALSE;
+    return TRUE;
+}
+
+void closeSource(SourceFile* sf)
+{
+    if (sf->buf == NULL) return;
+    if (sf->mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile((void*)sf->buf);
+#else
+        munmap((void*)sf->buf, (size_t)sf->len);
+#endif
+    }
+    else if (sf->buf != emptyBuf) {
+        free((char*)sf->buf);
+    }
+    free(sf->lineStart);
+    sf->buf = NULL;
+    sf->len = 0;
+    initLines(sf);
+}
+
+static void pushLine(SourceFile* sf, int start)
+{
+    if (sf->nlines == sf->lineCap) {
+        int cap = sf->lineCap ? sf->lineCap * 2 : 1024;
+        int* p = (int*)realloc(sf->lineStart, sizeof(int) * cap);
+        if (p == NULL) {
+            fprintf(stderr, "Error: Out of memory for line table\n");
+            exit(1);
+        }
+        sf->lineStart = p;
+        sf->lineCap = cap;
+    }
+    sf->lineStart[sf->nlines++] = start;
+}
+
+/* offset 을 포함하는 줄까지 줄 시작 테이블을 늘린다 */
+static void extendLines(SourceFile* sf, int offset)
+{
+    if (sf->nlines == 0 && sf->len > 0)
+        pushLine(sf, 0);
+    while (sf->scanned <= offset && sf->scanned < sf->len) {
+        const char* p = (const char*)memchr(sf->buf + sf->scanned, '\n',
+            (size_t)(sf->len - sf->scanned));
+        if (p == NULL) {
+            sf->scanned = sf->len;
+            break;
+        }
+        sf->scanned = (int)(p - sf->buf) + 1;
+        if (sf->scanned < sf->len)
+            pushLine(sf, sf->scanned);
+    }
+}
+
+int srcLineCount(SourceFile* sf)
+{
+    extendLines(sf, sf->len);
+    return sf->nlines;
+}
+
+int srcLineOf(SourceFile* sf, int offset)
+{
+    int lo, hi;
+
+    if (offset >= sf->len)
+        return srcLineCount(sf) + 1;
+    extendLines(sf, offset);
+
+    /* 순차 조회: 직전 줄이나 그 다음 줄인 경우가 대부분 */
+    lo = sf->lastLine;
+    if (sf->lineStart[lo] <= offset) {
+        if (lo + 1 >= sf->nlines || offset < sf->lineStart[lo + 1])
+            return lo + 1;
+        if (lo + 2 >= sf->nlines || offset < sf->lineStart[lo + 2]) {
+            sf->lastLine = lo + 1;
+            return lo + 2;
+        }
+    }
+
+    /* 이진 탐색: lineStart[lo] <= offset 인 가장 큰 lo */
+    lo = 0;
+    hi = sf->nlines - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (sf->lineStart[mid] <= offset) lo = mid;
+        else hi = mid - 1;
+    }
+    sf->lastLine = lo;
+    return lo + 1;
+}
+
+int srcLineSpan(SourceFile* sf, int line, int* length)
+{
+    int start, end;
+
+    /* 다음 줄의 시작을 알아야 이 줄의 끝을 안다 */
+    extendLines(sf, 0);
+    while (sf->nlines <= line && sf->scanned < sf->len)
+        extendLines(sf, sf->scanned);
+    if (line < 1 || line > sf->nlines) {
+        *length = 0;
+        return sf->len;
+    }
+    start = sf->lineStart[line - 1];
+    end = (line < sf->nlines) ? sf->lineStart[line] : sf->len;
+    *length = end - start;
+    return start;
+}
@@ -0,0 +1,46 @@
+/****************************************************/
+/* File: source.h                                   */
+/* Memory-mapped source input for the C- scanner    */
+/****************************************************/
+
+#ifndef _SOURCE_H_
+#define _SOURCE_H_
+
+/* 소스 파일 전체를 한 번에 매핑한 버퍼.
+ * 스캐너는 이 버퍼를 직접 읽고 토큰을 (오프셋, 길이) 조각으로 돌려준다.
+ * buf[len] 은 항상 '\0' 이므로 끝 검사용 보초(sentinel)로 쓸 수 있다. */
+typedef struct {
+    const char* buf;  /* 파일 내용 */
+    int len;          /* 파일 길이 (바이트) */
+    int mapped;       /* 1: mmap, 0: heap 복사본 (해제 방식 구분) */
+
+    /* 줄 시작 오프셋 테이블: 필요한 위치까지만 뒤로 늘려 간다 (lazy) */
+    int* lineStart;
+    int nlines;       /* 지금까지 찾은 줄 수 */
+    int lineCap;
+    int scanned;      /* 개행을 찾아 본 위치 */
+    int lastLine;     /* 최근 조회한 줄 (순차 조회 가속용) */
+} SourceFile;
+
+/* 컴파일 중인 소스 파일 */
+extern SourceFile source;
+
+/* 파일을 열어 버퍼에 매핑, 실패하면 FALSE */
+int openSource(SourceFile* sf, const char* fname);
+
+/* 이미 메모리에 있는 내용으로 SourceFile 구성 (내용은 복사됨) */
+int openSourceMemory(SourceFile* sf, const char* text, int len);
+
+void closeSource(SourceFile* sf);
+
+/* offset 위치 문자가 속한 줄 번호 (1부터).
+ * offset == len 이면 파일 끝(EOF)을 읽은 것으로 보고 마지막 줄 + 1 */
+int srcLineOf(SourceFile* sf, int offset);
+
+/* 줄 번호 line 의 시작 오프셋과 길이 (개행 포함) */
+int srcLineSpan(SourceFile* sf, int line, int* length);
+
+/* 실제 줄 수 (마지막 줄이 개행 없이 끝나도 한 줄로 셈) */
+int srcLineCount(SourceFile* sf);
+
+#endif
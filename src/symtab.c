@@ -1,123 +1,360 @@
 #include "globals.h"
 #include "symtab.h"
 #include "util.h"
+#include "arena.h"
+#include "intern.h"
 #include <string.h>
 #include <stdlib.h>
 
-// 해시 테이블 초기화
-BucketListPtr hashTable[SIZE];
 // 전역 범위(0)에서 시작
-int currentScope = 0; 
+THREAD_LOCAL int currentScope = 0;
 
-// 해시 테이블 초기화 함수 정의
+// 이름(atom) 하나에 슬롯 하나인 open addressing 해시 테이블 (Robin Hood).
+// 슬롯은 그 이름의 가장 안쪽 항목을 가리키고, 바깥 범위의 같은 이름은
+// next 로 이어지므로 st_lookup 은 슬롯 하나를 찾으면 끝난다
+#define MIN_CAPACITY 256   // 2의 거듭제곱
+#define MAX_LOAD_NUM 7     // 사용 슬롯이 7/8 을 넘으면 두 배로
+#define MAX_LOAD_DEN 8
+#define EMPTY_ATOM   (-1)
+
+typedef struct {
+    int atom;               // EMPTY_ATOM 이면 빈 슬롯
+    unsigned int hash;      // 캐시한 해시 (탐사 거리 계산, 옮길 때 재계산 없음)
+    BucketListPtr top;      // 가장 안쪽 항목 (범위를 모두 나가면 NULL, 키울 때 버림)
+} Slot;
+
+// 범위 하나의 기록: 그 범위에 넣은 항목들(최근 것부터)과 다음 메모리 위치.
+// 범위를 나갈 때 이 항목들만 빼므로 버킷 전체를 훑지 않는다
+typedef struct {
+    BucketListPtr added;
+    int nextLoc;
+} ScopeFrame;
+
+// 심볼 테이블 하나. 스레드마다 따로 두고 (병렬 의미 분석),
+// 전역 선언만 담은 테이블은 st_freeze_globals 로 모든 스레드가 읽게 한다
+typedef struct {
+    Slot* slot;
+    unsigned int mask;      // 크기 - 1
+    int used;               // 빈 슬롯이 아닌 슬롯 수
+
+    // 범위 번호로 찾는 표 (필요한 만큼 늘림). 함수 재선언 뒤에는 범위가
+    // 음수가 될 수 있어서 음수 범위는 따로 둔다 (-1 → negFrames[0])
+    ScopeFrame* frames;
+    int frameCap;
+    ScopeFrame* negFrames;
+    int negFrameCap;
+
+    // 누적 조회 통계 (st_stats)
+    long long lookups;
+    long long probes;
+} SymTab;
+
+static THREAD_LOCAL SymTab tab;
+
+// 읽기 전용 전역 테이블: slot 이 NULL 이면 없음.
+// globalLimit 보다 뒤에(memloc 이 큰) 선언된 전역은 보이지 않는다
+static SymTab globalTab;
+static THREAD_LOCAL int globalLimit = 0;
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in symbol table\n");
+    exit(1);
+}
+
+static ScopeFrame* growFrames(ScopeFrame* p, int* cap, int need)
+{
+    int n = *cap ? *cap : 64;
+    while (n <= need) n *= 2;
+    p = (ScopeFrame*)realloc(p, sizeof(ScopeFrame) * n);
+    if (p == NULL) outOfMemory();
+    memset(p + *cap, 0, sizeof(ScopeFrame) * (n - *cap));
+    *cap = n;
+    return p;
+}
+
+static ScopeFrame* frameOf(int scope)
+{
+    if (scope >= 0) {
+        if (scope >= tab.frameCap) tab.frames = growFrames(tab.frames, &tab.frameCap, scope);
+        return &tab.frames[scope];
+    }
+    if (-scope - 1 >= tab.negFrameCap) tab.negFrames = growFrames(tab.negFrames, &tab.negFrameCap, -scope - 1);
+    return &tab.negFrames[-scope - 1];
+}
+
+static void allocTable(unsigned int capacity)
+{
+    tab.slot = (Slot*)malloc(sizeof(Slot) * capacity);
+    if (tab.slot == NULL) outOfMemory();
+    for (unsigned int i = 0; i < capacity; i++) {
+        tab.slot[i].atom = EMPTY_ATOM;
+        tab.slot[i].top = NULL;
+    }
+    tab.mask = capacity - 1;
+    tab.used = 0;
+}
+
+// 해시 테이블 초기화 함수 정의 (이 스레드의 테이블)
 void initSymTab() {
-    for (int i = 0; i < SIZE; i++) {
-        hashTable[i] = NULL;
+    free(tab.slot);
+    allocTable(MIN_CAPACITY);
+    tab.lookups = tab.probes = 0;
+    if (tab.frameCap > 0) memset(tab.frames, 0, sizeof(ScopeFrame) * tab.frameCap);
+    if (tab.negFrameCap > 0) memset(tab.negFrames, 0, sizeof(ScopeFrame) * tab.negFrameCap);
+}
+
+void freeSymTab(void)
+{
+    free(tab.slot);
+    free(tab.frames);
+    free(tab.negFrames);
+    memset(&tab, 0, sizeof(tab));
+}
+
+void st_freeze_globals(void)
+{
+    globalTab = tab;
+    memset(&tab, 0, sizeof(tab));
+}
+
+void st_thaw_globals(void)
+{
+    tab = globalTab;
+    memset(&globalTab, 0, sizeof(globalTab));
+}
+
+void st_use_globals(int limit)
+{
+    globalLimit = limit;
+}
+
+void st_enter_scope(int scope)
+{
+    frameOf(scope)->nextLoc = 0;
+}
+
+int st_next_loc(int scope)
+{
+    return frameOf(scope)->nextLoc++;
+}
+
+// 해시 함수: atom 은 0 부터 연속된 정수라 murmur3 의 마무리 섞기로 흩는다
+static unsigned int hash(int atom)
+{
+    unsigned int h = (unsigned int)atom;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// 슬롯 i 에 있는 항목이 제자리(hash & mask)에서 떨어진 거리
+static unsigned int distance(const SymTab* t, unsigned int h, unsigned int i)
+{
+    return (i - h) & t->mask;
+}
+
+// 이름의 슬롯 (없으면 NULL). Robin Hood 순서라 제자리에서 더 멀리 온
+// 항목만 뒤에 있으므로, 거리가 지금보다 짧은 슬롯을 만나면 없는 것이다
+static Slot* findSlot(SymTab* t, int atom)
+{
+    unsigned int h = hash(atom);
+    unsigned int i = h & t->mask;
+    unsigned int d = 0;
+
+    tab.lookups++;
+    for (;;) {
+        Slot* s = &t->slot[i];
+        tab.probes++;
+        if (s->atom == EMPTY_ATOM || distance(t, s->hash, i) < d)
+            return NULL;
+        if (s->hash == h && s->atom == atom)
+            return s;
+        i = (i + 1) & t->mask;
+        d++;
     }
 }
 
-// 간단한 해시 함수: 문자열을 정수로 변환 후 SIZE로 나눈 나머지 사용
-static int hash(char *key)
+// 테이블에 없는 이름을 넣는다: 제자리에서 덜 떨어진 항목을 밀어내며 진행.
+// 새 이름이 놓인 슬롯을 돌려준다
+static Slot* placeSlot(int atom, unsigned int h, BucketListPtr top)
 {
-    int temp = 0;
-    int i = 0;
-    while (key[i] != '\0')
-    {
-        // 해시 함수 로직
-        temp = ((temp << 2) + key[i]) % SIZE;
-        i++;
+    Slot cur, tmp;
+    Slot* placed = NULL;
+    unsigned int i = h & tab.mask;
+    unsigned int d = 0;
+
+    cur.atom = atom;
+    cur.hash = h;
+    cur.top = top;
+    tab.used++;
+    for (;;) {
+        Slot* s = &tab.slot[i];
+        unsigned int sd;
+        if (s->atom == EMPTY_ATOM) {
+            *s = cur;
+            return placed ? placed : s;
+        }
+        sd = distance(&tab, s->hash, i);
+        if (sd < d) {
+            tmp = *s;
+            *s = cur;
+            cur = tmp;
+            if (placed == NULL) placed = s;
+            d = sd;
+        }
+        i = (i + 1) & tab.mask;
+        d++;
     }
-    return temp;
 }
 
-// 심볼 테이블에 항목 삽입
-void st_insert(char *name, ExpType type, int loc, int scope, TreeNode *node)
+// 두 배로 키우며 다시 배치. 범위를 모두 나가 항목이 없는 이름은 이때 버린다
+static void growTable(void)
 {
-    int h = hash(name);
+    Slot* old = tab.slot;
+    unsigned int oldCap = tab.mask + 1;
+
+    allocTable(oldCap * 2);
+    for (unsigned int i = 0; i < oldCap; i++)
+        if (old[i].atom != EMPTY_ATOM && old[i].top != NULL)
+            placeSlot(old[i].atom, old[i].hash, old[i].top);
+    free(old);
+}
+
+// 심볼 테이블에 항목 삽입 (만든 항목을 돌려줌)
+BucketListPtr st_insert(int atom, ExpType type, int loc, int scope, TreeNode *node)
+{
+    Slot* s;
     // 중복 검사는 semantic.c의 insertNode에서 담당
-    
-    BucketListPtr newBucket = (BucketListPtr)malloc(sizeof(struct BucketList));
-    if (newBucket == NULL) {
-        // 메모리 할당 실패 처리 (util.c의 lineno 대신 0 사용 또는 전역 Error 설정)
-        // fprintf(listing, "Error: Out of memory in st_insert\n"); 
-        return; 
-    }
-    
-    newBucket->name = copyString(name); // util.c의 copyString 사용
+
+    // 노드가 계속 가리킬 수 있도록 AST 와 같은 arena 에 (메모리가 없으면 종료)
+    BucketListPtr newBucket = (BucketListPtr)arenaAlloc(curArena, sizeof(struct BucketList));
+
+    newBucket->atom = atom; // 이름 문자열은 복사하지 않음
     newBucket->type = type;
     newBucket->memloc = loc;
     newBucket->scope = scope;
     newBucket->node = node;
-    
-    // 리스트의 맨 앞에 삽입 (해시 충돌 처리)
-    newBucket->next = hashTable[h]; 
-    hashTable[h] = newBucket;
+    newBucket->index = -1;
+
+    // 이름의 슬롯을 찾고 (없으면 새로), 그 체인의 맨 앞에 삽입 (바깥 범위를 가림)
+    s = findSlot(&tab, atom);
+    if (s == NULL) {
+        if ((unsigned int)(tab.used + 1) * MAX_LOAD_DEN > (tab.mask + 1) * MAX_LOAD_NUM)
+            growTable();
+        s = placeSlot(atom, hash(atom), NULL);
+    }
+    newBucket->next = s->top;
+    newBucket->prev = NULL;
+    if (newBucket->next != NULL)
+        newBucket->next->prev = newBucket;
+    s->top = newBucket;
+
+    // 범위를 나갈 때 되돌릴 수 있게 범위 기록에도 연결
+    ScopeFrame* f = frameOf(scope);
+    newBucket->scopeNext = f->added;
+    f->added = newBucket;
+    return newBucket;
+}
+
+// 읽기 전용 전역 테이블에서 (이 스레드에 보이는 것만)
+static BucketListPtr lookupGlobal(int atom)
+{
+    Slot* s;
+
+    if (globalTab.slot == NULL) return NULL;
+    s = findSlot(&globalTab, atom);
+    if (s == NULL || s->top == NULL || s->top->memloc > globalLimit) return NULL;
+    return s->top;
 }
 
 // 심볼 테이블에서 이름으로 항목 탐색 (가장 가까운 범위부터 찾음)
-BucketListPtr st_lookup(char *name)
+BucketListPtr st_lookup(int atom)
 {
-    int h = hash(name);
-    BucketListPtr l = hashTable[h];
-    // Global scope (scope 0)까지 탐색하며 가장 먼저 찾은 항목을 반환
+    Slot* s = findSlot(&tab, atom);
+    // 슬롯의 첫 항목이 가장 안쪽 범위의 선언
+    if (s != NULL && s->top != NULL) return s->top;
+    return lookupGlobal(atom);
+}
+
+// 특정 범위 내에서만 항목 탐색 (주로 중복 선언 검사에 사용)
+BucketListPtr st_lookup_scope(int atom, int scope)
+{
+    Slot* s = findSlot(&tab, atom);
+    BucketListPtr l = s != NULL ? s->top : NULL;
+
     while (l != NULL)
     {
-        if (strcmp(name, l->name) == 0)
+        // 같은 이름의 체인에서 범위가 일치하는 항목을 찾음
+        if (l->scope == scope)
             return l;
         l = l->next;
     }
+    if (scope == 0)
+        return lookupGlobal(atom);
     return NULL;
 }
 
-// 특정 범위 내에서만 항목 탐색 (주로 중복 선언 검사에 사용)
-BucketListPtr st_lookup_scope(char *name, int scope)
+// 특정 범위가 끝날 때 해당 범위의 모든 항목 삭제:
+// 그 범위에 넣은 항목만 이름별 체인에서 떼어 낸다 (O(항목 수)).
+// 슬롯은 그대로 두어 다른 이름을 옮기지 않고, 항목은 노드가 가리키므로 해제하지 않는다
+void st_delete_scope(int scope)
 {
-    int h = hash(name);
-    BucketListPtr l = hashTable[h];
-    
+    ScopeFrame* f = frameOf(scope);
+    BucketListPtr l = f->added;
+
     while (l != NULL)
     {
-        // 이름과 범위가 모두 일치하는 항목을 찾음
-        if (l->scope == scope && strcmp(name, l->name) == 0)
-            return l;
-        l = l->next;
+        if (l->prev != NULL)
+            l->prev->next = l->next;
+        else
+            findSlot(&tab, l->atom)->top = l->next;
+        if (l->next != NULL)
+            l->next->prev = l->prev;
+        l = l->scopeNext;
     }
+    f->added = NULL;
+}
+
+// 내장 함수: 런타임(cgen.c)이 제공하므로 선언 노드가 없다
+static struct BucketList builtinInput = { ATOM_INPUT, Integer, 0, 0, NULL, NULL, NULL, NULL, -1 };
+static struct BucketList builtinOutput = { ATOM_OUTPUT, Void, 1, 0, NULL, NULL, NULL, NULL, -1 };
+
+BucketListPtr st_builtin(int atom)
+{
+    if (atom == ATOM_INPUT) return &builtinInput;
+    if (atom == ATOM_OUTPUT) return &builtinOutput;
     return NULL;
 }
 
-// 특정 범위가 끝날 때 해당 범위의 모든 항목 삭제
-void st_delete_scope(int scope)
+void st_stats(FILE *out)
 {
-    for (int h = 0; h < SIZE; h++)
-    {
-        BucketListPtr l = hashTable[h];
-        BucketListPtr prev = NULL;
-
-        while (l != NULL)
-        {
-            if (l->scope == scope)
-            {
-                // 현재 항목이 삭제할 범위인 경우
-                BucketListPtr temp = l;
-                if (prev == NULL) {
-                    // 해시 테이블의 헤드를 삭제하는 경우
-                    hashTable[h] = l->next;
-                } 
-                else {
-                    // 리스트 중간 항목을 삭제하는 경우
-                    prev->next = l->next;
-                }
-                
-                l = l->next; // 다음 항목으로 이동
-                free(temp->name);
-                free(temp); 
-            }
-            else
-            {
-                // 현재 항목을 보존하고 다음으로 이동
-                prev = l;
-                l = l->next;
-            }
-        }
+    unsigned int cap = tab.mask + 1;
+    unsigned int maxDist = 0;
+    long long sumDist = 0;
+    int live = 0, maxChain = 0;
+
+    if (tab.slot == NULL) return;
+    for (unsigned int i = 0; i < cap; i++) {
+        unsigned int d;
+        int chain = 0;
+        if (tab.slot[i].atom == EMPTY_ATOM) continue;
+        d = distance(&tab, tab.slot[i].hash, i);
+        sumDist += d;
+        if (d > maxDist) maxDist = d;
+        for (BucketListPtr l = tab.slot[i].top; l != NULL; l = l->next)
+            chain++;
+        if (chain > 0) live++;
+        if (chain > maxChain) maxChain = chain;
     }
+    fprintf(out, "\nSymbol table: %u slots, %d names (%d live), load %.2f\n",
+            cap, tab.used, live, (double)tab.used / cap);
+    fprintf(out, "  probe distance: max %u, avg %.2f\n",
+            maxDist, tab.used > 0 ? (double)sumDist / tab.used : 0.0);
+    fprintf(out, "  same-name chain: max %d\n", maxChain);
+    fprintf(out, "  lookups: %lld, probes per lookup %.2f\n",
+            tab.lookups, tab.lookups > 0 ? (double)tab.probes / tab.lookups : 0.0);
 }
@@ -4,31 +4,49 @@
 #include "globals.h"
 #include "parse.h" // TreeNode 정의를 포함
 
-// 최대 심볼 테이블 크기 (해시 테이블 크기)
-#define SIZE 211
-
-// 심볼 테이블 항목 구조체 정의
+// 심볼 테이블 항목 구조체 정의.
+// 항목은 curArena 에 할당되고 st_delete_scope 가 해제하지 않으므로,
+// AST 노드의 sym 이 분석이 끝난 뒤에도 (arena 와 함께) 유효하다
 typedef struct BucketList
 {
-    char *name;               // 식별자 이름
+    int atom;                 // 식별자 이름 (intern.h 의 atom)
     ExpType type;             // 식별자의 타입 (Integer/Void)
     int memloc;               // 메모리 위치 (주소 할당 시 사용)
     int scope;                // 식별자가 선언된 범위 (0: Global, 1이상: Local)
     TreeNode *node;           // 이 심볼을 선언한 AST 노드 포인터 (추가 정보 저장용)
-    struct BucketList *next;  // 해시 충돌 및 연결 리스트용
+    struct BucketList *next;  // 같은 이름의 바깥 범위 항목 (이 항목이 가리는 것)
+    struct BucketList *prev;  // 같은 이름의 안쪽 범위 항목 (NULL 이면 테이블 슬롯이 가리킴)
+    struct BucketList *scopeNext; // 같은 범위에서 먼저 넣은 항목 (범위별 되돌리기 기록)
+    int index;                // 이후 단계가 붙이는 번호 (ir.c: 함수 안의 지역 변수 번호)
 } * BucketListPtr;
 
-// 심볼 테이블 (해시 테이블 배열)
-extern BucketListPtr hashTable[SIZE];
-
-// 현재 유효 범위 (Scope) 카운터
-extern int currentScope;
+// 현재 유효 범위 (Scope) 카운터 (스레드마다)
+extern THREAD_LOCAL int currentScope;
 
 // --- 함수 선언 ---
-void st_insert(char *name, ExpType type, int loc, int scope, TreeNode *node);
-BucketListPtr st_lookup(char *name);
-BucketListPtr st_lookup_scope(char *name, int scope);
+BucketListPtr st_insert(int atom, ExpType type, int loc, int scope, TreeNode *node);
+BucketListPtr st_lookup(int atom);
+BucketListPtr st_lookup_scope(int atom, int scope);
 void st_delete_scope(int scope);
-void initSymTab(); // 해시 테이블 초기화 함수 선언
+// 내장 함수 input / output 의 항목 (node 는 NULL, 테이블에는 없음). 아니면 NULL
+BucketListPtr st_builtin(int atom);
+void initSymTab(); // 해시 테이블 초기화 함수 선언 (부른 스레드의 테이블)
+void freeSymTab(void);
+
+// 병렬 의미 분석: 이 스레드의 테이블(전역 선언)을 모든 스레드가 읽는
+// 전역 테이블로 넘기고 (이 스레드는 빈 테이블), thaw 로 되찾는다.
+// 각 스레드는 자기 테이블에서 못 찾으면 전역 테이블을 보되,
+// memloc 이 st_use_globals 로 준 limit 이하인 전역만 보인다
+void st_freeze_globals(void);
+void st_thaw_globals(void);
+void st_use_globals(int limit);
+
+// 범위별 메모리 위치 카운터: st_enter_scope 로 0 부터 다시 세고,
+// st_next_loc 는 그 범위의 다음 위치를 돌려준다
+void st_enter_scope(int scope);
+int st_next_loc(int scope);
+
+// 테이블 크기, 부하율, 탐사 거리, 같은 이름 체인 길이, 누적 조회 수를 출력 (-symstats)
+void st_stats(FILE *out);
 
 #endif
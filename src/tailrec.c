@@ -0,0 +1,303 @@
+/****************************************************/
+/* File: tailrec.c                                  */
+/* Tail recursion elimination for the C- compiler   */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "ir.h"
+#include "tailrec.h"
+
+/* f(p...) { 몸 } 을 다음 꼴로 바꾼다 (acc 는 누산 자리가 있을 때만):
+ *
+ *   B0:  p = param; acc0 = 항등원; jmp H
+ *   H:   p' = phi(p, 인자...); acc = phi(acc0, ...); 몸 (p 대신 p')
+ *
+ * "return f(e...)"           →  p' 에 e 를 넘기며 jmp H
+ * "return a op f(e...)"      →  acc 에 acc op a 를 넘기며 jmp H   (op 는 + 또는 *)
+ * 그 밖의 "return v"         →  return acc op v
+ *
+ * + 와 * 는 32비트에서 돌아도 결합 / 교환 법칙이 그대로 서므로 값이 같다.
+ * a 는 호출 전에 이미 계산되어 있어야 하고 (호출 뒤에는 상수만 허용),
+ * 함수 안의 자기 호출이 모두 이런 자리여야 한다 (fib 처럼 두 번 부르면 그대로 둔다) */
+
+static void outOfMemory(void)
+{
+    fprintf(stderr, "Error: Out of memory in optimizer\n");
+    exit(1);
+}
+
+static void* allocArray(size_t n, size_t size)
+{
+    void* p = calloc(n > 0 ? n : 1, size);
+    if (p == NULL) outOfMemory();
+    return p;
+}
+
+/* 자기 호출 자리 */
+typedef struct {
+    int block;
+    int call;      /* 블록 안 CALL 의 위치 */
+    int bin;       /* 누산 자리면 결과를 만드는 BIN 의 위치, 꼬리 호출이면 -1 */
+    int ret;       /* 빈 "return;" 블록으로 넘어가는 void 꼬리 호출이면 그 블록, 아니면 -1 */
+} Site;
+
+static int isSelfCall(const IrFunc* f, const IrInst* in)
+{
+    return in->op == IR_CALL && in->sym->atom == f->decl->attr.atom;
+}
+
+/* block 이 "r = f(...); [상수...]; [t = r op a]; return" 으로 끝나면 s 를 채운다 */
+static int matchSite(const IrFunc* f, int block, Site* s)
+{
+    const IrBlock* b = &f->block[block];
+    const IrInst* call;
+    const IrInst* bin;
+    int k = b->ninst - 1;
+
+    s->block = block;
+    s->bin = -1;
+    s->ret = -1;
+    if (b->term == TERM_JMP) {
+        const IrBlock* r = &f->block[b->succ[0]];
+        if (r->ninst > 0 || r->term != TERM_RET || r->value >= 0) return FALSE;
+        s->ret = b->succ[0];
+    }
+    else if (b->term != TERM_RET)
+        return FALSE;
+
+    if (s->ret < 0 && k >= 0 && b->inst[k].op == IR_BIN) {
+        s->bin = k--;
+        while (k >= 0 && b->inst[k].op == IR_CONST) k--;
+    }
+    if (k < 0 || !isSelfCall(f, &b->inst[k])) return FALSE;
+    call = &b->inst[k];
+    s->call = k;
+    if (s->bin < 0)
+        return s->ret >= 0 ? call->dst < 0 : b->value == call->dst;
+
+    bin = &b->inst[s->bin];
+    if (bin->imm != PLUS && bin->imm != TIMES) return FALSE;
+    if (call->dst < 0 || b->value != bin->dst) return FALSE;
+    /* 호출 값은 이 BIN 에서 한 번만 쓴다 (블록이 return 으로 끝나므로 다른 곳에서는 못 쓴다) */
+    return (bin->a == call->dst) != (bin->b == call->dst);
+}
+
+static int mapValue(const int* repl, int v)
+{
+    return v >= 0 && repl[v] >= 0 ? repl[v] : v;
+}
+
+/* 상수 imm 으로 정의된 값인가 */
+static int isConstValue(const IrFunc* f, int v, int imm)
+{
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        const IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++)
+            if (b->inst[k].dst == v) return b->inst[k].op == IR_CONST && b->inst[k].imm == imm;
+    }
+    return FALSE;
+}
+
+static void renameBlock(IrRegion* r, int from, int to)
+{
+    for (; r != NULL; r = r->next) {
+        if (r->kind != IRS_SEQ && r->block == from) r->block = to;
+        renameBlock(r->body, from, to);
+        renameBlock(r->alt, from, to);
+    }
+}
+
+long eliminateTailCalls(IrFunc* f)
+{
+    Site* site;
+    int* param;
+    int* phi;
+    int** phiArgs;
+    int* repl;
+    int nsites = 0, nself = 0, accOp = -1, ok = TRUE;
+    int np = f->nparams, nphi, npred, h, identity = -1;
+    IrRegion* loop;
+    IrRegion* top;
+
+    if (!f->ssa || f->nblocks == 0 || f->block[0].npred > 0) return 0;
+
+    site = (Site*)allocArray((size_t)f->nblocks, sizeof(Site));
+    for (int bi = 0; bi < f->nblocks && ok; bi++) {
+        const IrBlock* b = &f->block[bi];
+        if (b->rpo < 0) continue;
+        for (int k = 0; k < b->ninst; k++)
+            if (isSelfCall(f, &b->inst[k])) nself++;
+        if (!matchSite(f, bi, &site[nsites])) continue;
+        if (site[nsites].bin >= 0) {
+            int op = b->inst[site[nsites].bin].imm;
+            if (accOp >= 0 && accOp != op) ok = FALSE;
+            accOp = op;
+        }
+        nsites++;
+    }
+    param = (int*)allocArray((size_t)np, sizeof(int));
+    for (int p = 0; p < np; p++) param[p] = -1;
+    for (int k = 0; k < f->block[0].ninst; k++) {
+        const IrInst* in = &f->block[0].inst[k];
+        if (in->op == IR_PARAM && in->imm >= 0 && in->imm < np) param[in->imm] = in->dst;
+    }
+    for (int p = 0; p < np; p++)
+        if (param[p] < 0) ok = FALSE;
+    if (!ok || nsites == 0 || nsites != nself) {
+        free(site);
+        free(param);
+        return 0;
+    }
+
+    h = irNewBlock(f);
+    nphi = np + (accOp >= 0 ? 1 : 0);
+    npred = nsites + 1;
+    phi = (int*)allocArray((size_t)nphi, sizeof(int));
+    phiArgs = (int**)allocArray((size_t)nphi, sizeof(int*));
+    for (int p = 0; p < nphi; p++) {
+        phi[p] = irNewValue(f, p < np ? f->valueVar[param[p]] : -1);
+        phiArgs[p] = (int*)allocArray((size_t)npred, sizeof(int));
+        phiArgs[p][0] = p < np ? param[p] : -1;
+    }
+    if (accOp >= 0) {
+        identity = irNewValue(f, -1);
+        phiArgs[np][0] = identity;
+    }
+
+    /* 1. 파라미터를 읽던 곳은 모두 머리의 PHI 를 읽는다 */
+    repl = (int*)allocArray((size_t)f->nvalues, sizeof(int));
+    for (int v = 0; v < f->nvalues; v++) repl[v] = -1;
+    for (int p = 0; p < np; p++) repl[param[p]] = phi[p];
+    for (int bi = 0; bi < f->nblocks; bi++) {
+        IrBlock* b = &f->block[bi];
+        for (int k = 0; k < b->ninst; k++) {
+            IrInst* in = &b->inst[k];
+            in->a = mapValue(repl, in->a);
+            in->b = mapValue(repl, in->b);
+            if (in->op == IR_CALL || in->op == IR_PHI)
+                for (int j = 0; j < in->nargs; j++) in->args[j] = mapValue(repl, in->args[j]);
+        }
+        if (b->term == TERM_BR || b->term == TERM_RET)
+            b->value = mapValue(repl, b->value);
+    }
+    free(repl);
+
+    /* 2. 자기 호출 자리는 인자를 PHI 로 넘기며 머리로 뛴다 */
+    for (int i = 0; i < nsites; i++) {
+        const Site* s = &site[i];
+        IrBlock* b = &f->block[s->block];
+        IrInst* call = &b->inst[s->call];
+
+        for (int p = 0; p < np; p++) phiArgs[p][i + 1] = call->args[p];
+        if (accOp >= 0 && s->bin >= 0) {
+            IrInst* bin = &b->inst[s->bin];
+            int a = bin->a == call->dst ? bin->b : bin->a;
+            bin->a = phi[np];
+            bin->b = a;
+            phiArgs[np][i + 1] = bin->dst;
+        }
+        else if (accOp >= 0)
+            phiArgs[np][i + 1] = phi[np];
+        call->op = IR_NOP;
+        if (s->ret >= 0) irRemovePred(f, s->ret, s->block);
+        b->term = TERM_JMP;
+        b->value = -1;
+        b->succ[0] = h;
+        b->nsucc = 1;
+    }
+
+    /* 3. 나머지 return 은 지금까지 쌓인 값과 합친다 */
+    if (accOp >= 0) {
+        for (int bi = 0; bi < f->nblocks; bi++) {
+            IrBlock* b = &f->block[bi];
+            IrInst* in;
+            if (b->rpo < 0 || b->term != TERM_RET) continue;
+            if (isConstValue(f, b->value, accOp == PLUS ? 0 : 1)) {
+                b->value = phi[np];
+                continue;
+            }
+            in = irAppend(f, bi, IR_BIN);
+            in->dst = irNewValue(f, -1);
+            in->a = phi[np];
+            in->b = b->value;
+            in->imm = accOp;
+            in->line = f->decl->lineno;
+            b->value = in->dst;
+        }
+    }
+
+    /* 4. 진입 블록의 몸을 머리 h 로 옮긴다. 진입에는 PARAM 과 누산기 초깃값만 남는다 */
+    {
+        IrBlock* e = &f->block[0];
+        IrBlock* hb = &f->block[h];
+        IrInst* old = e->inst;
+        int nold = e->ninst;
+
+        hb->inst = (IrInst*)allocArray((size_t)(nphi + nold), sizeof(IrInst));
+        hb->cap = nphi + nold;
+        for (int p = 0; p < nphi; p++) {
+            IrInst* in = &hb->inst[hb->ninst++];
+            in->op = IR_PHI;
+            in->dst = phi[p];
+            in->a = in->b = -1;
+            in->imm = p < np ? f->valueVar[param[p]] : -1;
+            in->args = phiArgs[p];
+            in->nargs = npred;
+            in->line = f->decl->lineno;
+        }
+        e->inst = NULL;
+        e->ninst = e->cap = 0;
+        for (int k = 0; k < nold; k++) {
+            if (old[k].op == IR_PARAM) *irAppend(f, 0, IR_PARAM) = old[k];
+            else hb->inst[hb->ninst++] = old[k];
+        }
+        free(old);
+        if (accOp >= 0) {
+            IrInst* in = irAppend(f, 0, IR_CONST);
+            in->dst = identity;
+            in->imm = accOp == PLUS ? 0 : 1;
+            in->line = f->decl->lineno;
+        }
+
+        hb->term = e->term;
+        hb->value = e->value;
+        hb->succ[0] = e->succ[0];
+        hb->succ[1] = e->succ[1];
+        hb->nsucc = e->nsucc;
+        for (int k = 0; k < hb->nsucc; k++) {
+            IrBlock* s = &f->block[hb->succ[k]];
+            int j = irPredIndex(s, 0);
+            if (j >= 0) s->pred[j] = h;
+        }
+        e->term = TERM_JMP;
+        e->value = -1;
+        e->succ[0] = h;
+        e->nsucc = 1;
+
+        hb->pred = (int*)allocArray((size_t)npred, sizeof(int));
+        hb->npred = npred;
+        hb->pred[0] = 0;
+        for (int i = 0; i < nsites; i++)
+            hb->pred[i + 1] = site[i].block == 0 ? h : site[i].block;
+    }
+
+    irCompact(f);
+    irDominators(f);
+
+    /* 5. 구조 트리: 진입 블록, 그 뒤에 몸 전체를 도는 LOOP */
+    renameBlock(f->region, 0, h);
+    loop = irNewRegion(IRS_LOOP, h);
+    loop->body = f->region;
+    top = irNewRegion(IRS_SEQ, -1);
+    top->body = irNewRegion(IRS_BLOCK, 0);
+    top->body->next = loop;
+    f->region = top;
+    irFixRegions(f, f->region);
+
+    free(site);
+    free(param);
+    free(phi);
+    free(phiArgs);
+    return nsites;
+}
@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: tailrec.h                                  */
+/* Tail recursion elimination for the C- compiler   */
+/****************************************************/
+
+#ifndef _TAILREC_H_
+#define _TAILREC_H_
+
+#include "globals.h"
+#include "ir.h"
+
+/* tailrec (IR): 자기 꼬리 호출을 함수 머리로 돌아가는 간선으로 바꾸고,
+ * return x * f(...) / return n + f(...) 처럼 결합 연산 하나로 끝나는 재귀는
+ * 누산기를 두어 같은 고리로 만든다. 함수 몸체는 LOOP 구조가 된다 */
+long eliminateTailCalls(IrFunc* f);
+
+#endif
@@ -0,0 +1,13 @@
+/* divide-by-zero test program */
+/* b 가 0 이면 -O0 이든 -O1 이든 첫 output 전에 ArithmeticException.
+ * 곱하기 0 이나 자기 빼기로 나눗셈이 지워지면 0 이 먼저 찍힌다 */
+void main(void)
+{
+    int a; int b;
+    a = input();
+    b = input();
+    output(a / b * 0);
+    output(a / b - a / b);
+    output(a - a / b * b);
+    output(a * 0);
+}
@@ -0,0 +1,177 @@
+/****************************************************/
+/* File: thread.c                                   */
+/* Portable thread helpers for the C- compiler      */
+/****************************************************/
+
+#include "globals.h"
+#include "thread.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sched.h>
+#endif
+
+/* 스레드 시작 인자 (fn, arg 를 한 덩어리로 넘김) */
+typedef struct {
+    ThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+#ifdef _WIN32
+static DWORD WINAPI threadMain(LPVOID p)
+#else
+static void* threadMain(void* p)
+#endif
+{
+    ThreadStart st = *(ThreadStart*)p;
+    free(p);
+    st.fn(st.arg);
+    return 0;
+}
+
+int threadStart(Thread* t, ThreadFn fn, void* arg)
+{
+    ThreadStart* st = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (st == NULL) return FALSE;
+    st->fn = fn;
+    st->arg = arg;
+#ifdef _WIN32
+    *t = CreateThread(NULL, 0, threadMain, st, 0, NULL);
+    if (*t == NULL) {
+        free(st);
+        return FALSE;
+    }
+#else
+    if (pthread_create(t, NULL, threadMain, st) != 0) {
+        free(st);
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+void threadJoin(Thread t)
+{
+#ifdef _WIN32
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+int cpuCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/* runParallel 의 작업자 하나 */
+typedef struct {
+    void (*fn)(void* arg, int k);
+    void* arg;
+    int k;
+} ParallelJob;
+
+static void parallelMain(void* p)
+{
+    ParallelJob* job = (ParallelJob*)p;
+    job->fn(job->arg, job->k);
+}
+
+void runParallel(int n, void (*fn)(void* arg, int k), void* arg)
+{
+    Thread* th;
+    ParallelJob* jobs;
+    int* started;
+
+    if (n <= 1) {
+        fn(arg, 0);
+        return;
+    }
+    th = (Thread*)malloc(sizeof(Thread) * n);
+    jobs = (ParallelJob*)malloc(sizeof(ParallelJob) * n);
+    started = (int*)calloc((size_t)n, sizeof(int));
+    if (th == NULL || jobs == NULL || started == NULL) {
+        fprintf(stderr, "Error: Out of memory starting threads\n");
+        exit(1);
+    }
+
+    for (int k = 0; k < n; k++) {
+        jobs[k].fn = fn;
+        jobs[k].arg = arg;
+        jobs[k].k = k;
+    }
+    for (int k = 1; k < n; k++)
+        started[k] = threadStart(&th[k], parallelMain, &jobs[k]);
+    fn(arg, 0);
+    /* 스레드를 만들지 못한 작업은 여기서 직접 실행 */
+    for (int k = 1; k < n; k++) {
+        if (started[k]) threadJoin(th[k]);
+        else fn(arg, k);
+    }
+
+    free(th);
+    free(jobs);
+    free(started);
+}
+
+void threadYield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+void queueInit(SpscQueue* q, int capacity)
+{
+    unsigned int size = 2;
+    while (size < (unsigned int)capacity)
+        size *= 2;
+    q->slot = (void**)malloc(sizeof(void*) * size);
+    if (q->slot == NULL) {
+        fprintf(stderr, "Error: Out of memory for queue\n");
+        exit(1);
+    }
+    q->mask = size - 1;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+}
+
+void queueFree(SpscQueue* q)
+{
+    free(q->slot);
+    q->slot = NULL;
+}
+
+void queuePush(SpscQueue* q, void* item)
+{
+    unsigned int t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    /* 소비자가 head 를 옮길 때까지 (가득 참) */
+    while (t - atomic_load_explicit(&q->head, memory_order_acquire) > q->mask)
+        threadYield();
+    q->slot[t & q->mask] = item;
+    atomic_store_explicit(&q->tail, t + 1, memory_order_release);
+}
+
+void* queuePop(SpscQueue* q)
+{
+    unsigned int h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    void* item;
+
+    /* 생산자가 tail 을 옮길 때까지 (비어 있음) */
+    while (atomic_load_explicit(&q->tail, memory_order_acquire) == h)
+        threadYield();
+    item = q->slot[h & q->mask];
+    atomic_store_explicit(&q->head, h + 1, memory_order_release);
+    return item;
+}
@@ -0,0 +1,54 @@
+/****************************************************/
+/* File: thread.h                                   */
+/* Portable thread helpers for the C- compiler      */
+/****************************************************/
+
+#ifndef _THREAD_H_
+#define _THREAD_H_
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE Thread;
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+#endif
+#include <stdatomic.h>
+
+typedef void (*ThreadFn)(void* arg);
+
+int threadStart(Thread* t, ThreadFn fn, void* arg);
+void threadJoin(Thread t);
+
+/* 사용 가능한 코어 수 */
+int cpuCount(void);
+
+/* n 개의 작업자로 fn(arg, 0) ... fn(arg, n-1) 을 동시에 실행하고 모두 기다린다.
+ * 0 번은 호출한 스레드에서 실행된다 */
+void runParallel(int n, void (*fn)(void* arg, int k), void* arg);
+
+/* 다른 스레드에 CPU 를 양보 */
+void threadYield(void);
+
+/* 생산자 하나, 소비자 하나 사이의 고정 크기 lock-free 큐.
+ * 가득 차면 queuePush 가, 비어 있으면 queuePop 이 양보하며 기다린다.
+ * 밀어 넣기 전의 쓰기는 꺼낸 쪽에서 모두 보인다 (release / acquire) */
+#define QUEUE_PAD 64  /* head 와 tail 을 다른 캐시 라인에 */
+
+typedef struct {
+    void** slot;
+    unsigned int mask;           /* 크기 - 1 (크기는 2의 거듭제곱) */
+    char pad0[QUEUE_PAD];
+    atomic_uint head;            /* 다음에 꺼낼 위치: 소비자만 쓴다 */
+    char pad1[QUEUE_PAD];
+    atomic_uint tail;            /* 다음에 넣을 위치: 생산자만 쓴다 */
+    char pad2[QUEUE_PAD];
+} SpscQueue;
+
+/* capacity 는 2의 거듭제곱으로 올린다 */
+void queueInit(SpscQueue* q, int capacity);
+void queueFree(SpscQueue* q);
+void queuePush(SpscQueue* q, void* item);
+void* queuePop(SpscQueue* q);
+
+#endif
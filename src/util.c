@@ -6,114 +6,136 @@
 #include "globals.h"
 #include "util.h"
 #include "parse.h"
-
-static int indentno = 0;
-
-#define INDENT   indentno += 4
-#define UNINDENT indentno -= 4
-
-/* 들여쓰기용 공백 출력 */
-static void printSpaces(void) {
-    for (int i = 0; i < indentno; i++)
+#include "intern.h"
+#include "arena.h"
+#include "visit.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/* 깊이 d 의 노드 들여쓰기: 목록 한 단계마다 4 칸 */
+static void printSpaces(int depth) {
+    for (int i = 0; i < (depth + 1) * 4; i++)
         fprintf(listing, " ");
 }
 
-/* 구문 트리(AST) 출력 */
-void printTree(TreeNode* tree) {
-    if (tree == NULL) return;
-
-    INDENT;
-    while (tree != NULL) {
-        printSpaces();
-
-        /* 노드 종류별 출력 */
-        if (tree->nodekind == StmtK) {
-            switch (tree->kind.stmt) {
-            case IfK:
-                fprintf(listing, "If\n");
-                break;
-            case ReturnK:
-                fprintf(listing, "Return\n");
-                break;
-            case WhileK:
-                fprintf(listing, "While\n");
-                break;
-            case CmpdK:
-                fprintf(listing, "Compound Stmt\n");
-                break;
-            default:
-                fprintf(listing, "Unknown StmtK\n");
-                break;
-            }
-        }
-        else if (tree->nodekind == ExpK) {
-            switch (tree->kind.exp) {
-            case OpK:
-                fprintf(listing, "Op: ");
-                switch (tree->attr.op) {
-                case PLUS:   fprintf(listing, "+\n");  break;
-                case MINUS:  fprintf(listing, "-\n");  break;
-                case TIMES:  fprintf(listing, "*\n");  break;
-                case OVER:   fprintf(listing, "/\n");  break;
-                case LT:     fprintf(listing, "<\n");  break;
-                case LTE:    fprintf(listing, "<=\n"); break;
-                case GT:     fprintf(listing, ">\n");  break;
-                case GTE:    fprintf(listing, ">=\n"); break;
-                case EQ:     fprintf(listing, "==\n"); break;
-                case NEQ:    fprintf(listing, "!=\n"); break;
-                case ASSIGN: fprintf(listing, "=\n");  break;
-                default:
-                    fprintf(listing, "Unknown Op\n");
-                    break;
-                }
-                break;
-            case ConstK:
-                fprintf(listing, "Const: %d\n", tree->attr.val);
-                break;
-            case IdK:
-                fprintf(listing, "Id: %s\n", tree->attr.name);
-                break;
-            case CallK:
-                fprintf(listing, "Call: %s\n", tree->attr.name);
-                break;
-            default:
-                fprintf(listing, "Unknown ExpK\n");
-                break;
-            }
+/* 노드 한 줄 출력 (종류와 속성): 포인터 트리와 flat 트리가 같이 쓴다 */
+void printNode(NodeKind nodekind, int kind, int attr) {
+    if (nodekind == StmtK) {
+        switch ((StmtKind)kind) {
+        case IfK:
+            fprintf(listing, "If\n");
+            break;
+        case ReturnK:
+            fprintf(listing, "Return\n");
+            break;
+        case WhileK:
+            fprintf(listing, "While\n");
+            break;
+        case CmpdK:
+            fprintf(listing, "Compound Stmt\n");
+            break;
+        default:
+            fprintf(listing, "Unknown StmtK\n");
+            break;
         }
-        else if (tree->nodekind == DeclK) {
-            switch (tree->kind.decl) {
-            case VarK:
-                fprintf(listing, "Var Decl: %s\n", tree->attr.name);
-                break;
-            case FunK:
-                fprintf(listing, "Func Decl: %s\n", tree->attr.name);
-                break;
-            case ParamK:
-                fprintf(listing, "Param: %s\n", tree->attr.name);
-                break;
+    }
+    else if (nodekind == ExpK) {
+        switch ((ExpKind)kind) {
+        case OpK:
+            fprintf(listing, "Op: ");
+            switch ((TokenType)attr) {
+            case PLUS:   fprintf(listing, "+\n");  break;
+            case MINUS:  fprintf(listing, "-\n");  break;
+            case TIMES:  fprintf(listing, "*\n");  break;
+            case OVER:   fprintf(listing, "/\n");  break;
+            case LT:     fprintf(listing, "<\n");  break;
+            case LTE:    fprintf(listing, "<=\n"); break;
+            case GT:     fprintf(listing, ">\n");  break;
+            case GTE:    fprintf(listing, ">=\n"); break;
+            case EQ:     fprintf(listing, "==\n"); break;
+            case NEQ:    fprintf(listing, "!=\n"); break;
+            case ASSIGN: fprintf(listing, "=\n");  break;
+            case MOD:    fprintf(listing, "%%\n");  break;
+            case SHL:    fprintf(listing, "<<\n"); break;
+            case SHR:    fprintf(listing, ">>\n"); break;
+            case USHR:   fprintf(listing, ">>>\n"); break;
             default:
-                fprintf(listing, "Unknown DeclK\n");
+                fprintf(listing, "Unknown Op\n");
                 break;
             }
+            break;
+        case ConstK:
+            fprintf(listing, "Const: %d\n", attr);
+            break;
+        case IdK:
+            fprintf(listing, "Id: %s\n", atomName(attr));
+            break;
+        case CallK:
+            fprintf(listing, "Call: %s\n", atomName(attr));
+            break;
+        default:
+            fprintf(listing, "Unknown ExpK\n");
+            break;
         }
-        else {
-            fprintf(listing, "Unknown node kind\n");
-        }
-
-        /* 자식들 출력 */
-        for (int i = 0; i < MAXCHILDREN; i++) {
-            printTree(tree->child[i]);
+    }
+    else if (nodekind == DeclK) {
+        switch ((DeclKind)kind) {
+        case VarK:
+            fprintf(listing, "Var Decl: %s\n", atomName(attr));
+            break;
+        case FunK:
+            fprintf(listing, "Func Decl: %s\n", atomName(attr));
+            break;
+        case ParamK:
+            fprintf(listing, "Param: %s\n", atomName(attr));
+            break;
+        default:
+            fprintf(listing, "Unknown DeclK\n");
+            break;
         }
+    }
+    else {
+        fprintf(listing, "Unknown node kind\n");
+    }
+}
 
-        /* 형제 노드 */
-        tree = tree->sibling;
+static int kindOf(TreeNode* t) {
+    switch (t->nodekind) {
+    case StmtK: return (int)t->kind.stmt;
+    case ExpK:  return (int)t->kind.exp;
+    default:    return (int)t->kind.decl;
     }
-    UNINDENT;
+}
+
+/* 노드마다 들여쓰기와 한 줄 (visit.h 의 PRE 훅) */
+#define PRINT_PRE(ctx, t, p, slot, d) \
+    (printSpaces(d), printNode((t)->nodekind, kindOf(t), (t)->attr.val), VISIT_ALL)
+DEFINE_TREE_VISITOR(printVisit, void, PRINT_PRE, VISIT_NOMID, VISIT_NOSIB, VISIT_NOPOST)
+
+#define PRINT_FLAT_PRE(ctx, i, p, slot, d) \
+    (printSpaces(d), printNode(flatNodeKind((ctx)->flat, i), flatKind((ctx)->flat, i), \
+        (ctx)->flat->attr[i]), VISIT_ALL)
+typedef struct { const FlatTree* flat; } FlatPrint;
+DEFINE_FLAT_VISITOR(printFlatVisit, FlatPrint, PRINT_FLAT_PRE, VISIT_NOMID, VISIT_NOSIB, VISIT_NOPOST)
+
+/* 구문 트리(AST) 출력 */
+void printTree(TreeNode* tree) {
+    printVisit(NULL, tree);
+}
+
+/* flat 트리 출력 (printTree 와 같은 형식) */
+void printFlatTree(const FlatTree* f) {
+    FlatPrint ctx;
+    ctx.flat = f;
+    printFlatVisit(&ctx, f->count > 0 ? 0 : -1);
 }
 
 /* 토큰 출력 (스캐너 디버깅용) */
-void printToken(TokenType token, const char* tokenString) {
+void printToken(TokenType token, const char* text, int len) {
     switch (token) {
     case ELSE:
     case IF:
@@ -121,7 +143,7 @@ void printToken(TokenType token, const char* tokenString) {
     case RETURN:
     case VOID:
     case WHILE:
-        fprintf(listing, "reserved word: %s\n", tokenString);
+        fprintf(listing, "reserved word: %.*s\n", len, text);
         break;
 
     case PLUS:     fprintf(listing, "+\n");  break;
@@ -145,16 +167,19 @@ void printToken(TokenType token, const char* tokenString) {
     case RBRACKET: fprintf(listing, "]\n");  break;
 
     case NUM:
-        fprintf(listing, "NUM, val = %s\n", tokenString);
+        fprintf(listing, "NUM, val = %.*s\n", len, text);
         break;
     case ID:
-        fprintf(listing, "ID, name = %s\n", tokenString);
+        fprintf(listing, "ID, name = %.*s\n", len, text);
         break;
     case ENDFILE:
         fprintf(listing, "EOF\n");
         break;
     case ERROR:
-        fprintf(listing, "ERROR: %s\n", tokenString);
+        fprintf(listing, "ERROR: %.*s\n", len, text);
+        break;
+    case INCLUDE:
+        fprintf(listing, "#include \"%.*s\"\n", len, text);
         break;
     default:
         fprintf(listing, "Unknown token: %d\n", token);
@@ -162,68 +187,58 @@ void printToken(TokenType token, const char* tokenString) {
     }
 }
 
-/* 문자열 복사 */
+/* 문자열 복사 (현재 arena 에 저장) */
 char* copyString(char* s) {
     if (s == NULL) return NULL;
-    int n = (int)strlen(s) + 1;
-    char* t = (char*)malloc(n);
-    if (t == NULL) {
-        fprintf(listing, "Error: Out of memory at line %d\n", lineno);
-    }
-    else {
-        strcpy(t, s);
-    }
+    return arenaStrndup(curArena, s, strlen(s));
+}
+
+/* 길이가 주어진 문자열 조각 복사 (소스 버퍼는 '\0' 으로 끝나지 않음) */
+char* copyStringN(const char* s, int n) {
+    return arenaStrndup(curArena, s, (size_t)n);
+}
+
+/* 노드 공통 초기화: 노드는 현재 arena 에 파싱 순서대로 놓인다 */
+static TreeNode* newNode(NodeKind nodekind) {
+    TreeNode* t = (TreeNode*)arenaAlloc(curArena, sizeof(TreeNode));
+    memset(t, 0, sizeof(TreeNode));
+    t->nodekind = nodekind;
+    t->lineno = lineno;
     return t;
 }
 
 /* 문장 노드 생성 */
 TreeNode* newStmtNode(StmtKind kind) {
-    TreeNode* t = (TreeNode*)malloc(sizeof(TreeNode));
-    if (t == NULL) {
-        fprintf(listing, "Error: Out of memory at line %d\n", lineno);
-    }
-    else {
-        for (int i = 0; i < MAXCHILDREN; i++)
-            t->child[i] = NULL;
-        t->sibling = NULL;
-        t->nodekind = StmtK;
-        t->kind.stmt = kind;
-        t->lineno = lineno;
-    }
+    TreeNode* t = newNode(StmtK);
+    t->kind.stmt = kind;
     return t;
 }
 
 /* 표현식 노드 생성 */
 TreeNode* newExpNode(ExpKind kind) {
-    TreeNode* t = (TreeNode*)malloc(sizeof(TreeNode));
-    if (t == NULL) {
-        fprintf(listing, "Error: Out of memory at line %d\n", lineno);
-    }
-    else {
-        for (int i = 0; i < MAXCHILDREN; i++)
-            t->child[i] = NULL;
-        t->sibling = NULL;
-        t->nodekind = ExpK;
-        t->kind.exp = kind;
-        t->lineno = lineno;
-        t->type = Void; /* 기본값 */
-    }
+    TreeNode* t = newNode(ExpK);
+    t->kind.exp = kind;
+    t->type = Void; /* 기본값 */
     return t;
 }
 
 /* 선언 노드 생성 */
 TreeNode* newDeclNode(DeclKind kind) {
-    TreeNode* t = (TreeNode*)malloc(sizeof(TreeNode));
-    if (t == NULL) {
-        fprintf(listing, "Error: Out of memory at line %d\n", lineno);
-    }
-    else {
-        for (int i = 0; i < MAXCHILDREN; i++)
-            t->child[i] = NULL;
-        t->sibling = NULL;
-        t->nodekind = DeclK;
-        t->kind.decl = kind;
-        t->lineno = lineno;
-    }
+    TreeNode* t = newNode(DeclK);
+    t->kind.decl = kind;
     return t;
 }
+
+/* 시간 측정 (벤치마크용) */
+double wallClock(void) {
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
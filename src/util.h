@@ -8,10 +8,13 @@
 
 #include "parse.h"
 #include "globals.h"
+#include "flat.h"
 
 
-void printToken(TokenType token, const char *tokenString);
+void printToken(TokenType token, const char *text, int len);
 void printTree(TreeNode * tree);
+void printFlatTree(const FlatTree* f);
+void printNode(NodeKind nodekind, int kind, int attr);
 
 TreeNode* newStmtNode(StmtKind kind);
 TreeNode* newExpNode(ExpKind kind);
@@ -19,5 +22,9 @@ TreeNode* newDeclNode(DeclKind kind);
 
 /* 토큰 문자열 복사를 위한 헬퍼 함수 */
 char* copyString(char* s);
+char* copyStringN(const char* s, int n);
+
+/* 시간 측정용 (초 단위, 단조 증가) */
+double wallClock(void);
 #endif
 
@@ -0,0 +1,26 @@
+/****************************************************/
+/* File: visit.c                                    */
+/* Iterative AST visitor for the C- compiler        */
+/****************************************************/
+
+#include "globals.h"
+#include "visit.h"
+
+void* visitGrow(void* stack, void* local, int* cap, size_t elem)
+{
+    size_t bytes = elem * (size_t)*cap;
+    void* p;
+
+    if (stack == local) {
+        p = malloc(bytes * 2);
+        if (p != NULL) memcpy(p, stack, bytes);
+    }
+    else
+        p = realloc(stack, bytes * 2);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Out of memory in tree visitor\n");
+        exit(1);
+    }
+    *cap *= 2;
+    return p;
+}
@@ -0,0 +1,103 @@
+/****************************************************/
+/* File: visit.h                                    */
+/* Iterative AST visitor for the C- compiler        */
+/****************************************************/
+
+#ifndef _VISIT_H_
+#define _VISIT_H_
+
+#include "globals.h"
+#include "parse.h"
+
+/* 재귀 없이 트리를 도는 방문기를 매크로로 만든다.
+ * 명시적 스택을 쓰므로 C 스택 사용량은 트리 모양과 상관없이 일정하고,
+ * 훅은 함수 포인터가 아니라 직접 호출이라 컴파일러가 인라인할 수 있다.
+ *
+ * 방문 순서 (노드 n, 부모 p, n 이 p 의 몇 번째 자식 목록에 있는지 slot, 깊이 d):
+ *   mask = PRE(ctx, n, p, slot, d)     방문할 자식 칸 (비트 k = child[k])
+ *   각 자식 칸 k (mask 에 있는 것만):
+ *     k > 0 이면 MID(ctx, n, k)        자식 칸 사이 (자식이 NULL 이어도 호출)
+ *     child[k] 의 형제 목록 전체 방문 (깊이 d + 1)
+ *   POST(ctx, n, p, slot)
+ *   형제가 있으면 SIB(ctx, n, p, slot) 후 형제로 (같은 p, slot, d)
+ * 뿌리의 부모는 NIL, slot 은 -1, 깊이는 0 이다 */
+
+#define VISIT_ALL   ((1 << MAXCHILDREN) - 1)
+#define VISIT_LOCAL 64   /* 이 깊이까지는 C 스택의 배열, 그 이상은 힙 */
+
+/* 쓰지 않는 훅 자리에 넣는다 */
+#define VISIT_NOPRE(ctx, n, p, slot, d)  VISIT_ALL
+#define VISIT_NOMID(ctx, n, k)           ((void)0)
+#define VISIT_NOSIB(ctx, n, p, slot)     ((void)0)
+#define VISIT_NOPOST(ctx, n, p, slot)    ((void)0)
+
+/* 스택을 두 배로 늘린다 (처음엔 local 배열에서 힙으로 옮긴다) */
+void* visitGrow(void* stack, void* local, int* cap, size_t elem);
+
+/* name(ctx, root): NodeT 는 노드 핸들, NIL 은 빈 핸들,
+ * CHILD(ctx, n, k) 와 SIBLING(ctx, n) 은 자식/형제 접근 */
+#define DEFINE_VISITOR(name, NodeT, NIL, CHILD, SIBLING, Ctx, PRE, MID, SIB, POST) \
+static void name(Ctx* ctx, NodeT root)                                       \
+{                                                                            \
+    typedef struct {                                                         \
+        NodeT node;                                                          \
+        NodeT parent;                                                        \
+        int slot, depth, next, mask;                                         \
+    } VisitFrame;                                                            \
+    VisitFrame local[VISIT_LOCAL];                                           \
+    VisitFrame* st = local;                                                  \
+    int cap = VISIT_LOCAL, top = 0;                                          \
+    (void)ctx;                                                               \
+    if (root == NIL) return;                                                 \
+    st[0].node = root; st[0].parent = NIL;                                   \
+    st[0].slot = -1; st[0].depth = 0; st[0].next = 0;                        \
+    top = 1;                                                                 \
+    st[0].mask = PRE(ctx, root, NIL, -1, 0);                                 \
+    while (top > 0) {                                                        \
+        VisitFrame* f = &st[top - 1];                                        \
+        if (f->next < MAXCHILDREN) {                                         \
+            int k = f->next++;                                               \
+            NodeT c;                                                         \
+            if (!(f->mask & (1 << k))) continue;                             \
+            if (k > 0) MID(ctx, f->node, k);                                 \
+            c = CHILD(ctx, f->node, k);                                      \
+            if (c == NIL) continue;                                          \
+            if (top == cap)                                                  \
+                st = (VisitFrame*)visitGrow(st, local, &cap, sizeof(VisitFrame)); \
+            f = &st[top - 1];                                                \
+            st[top].node = c; st[top].parent = f->node;                      \
+            st[top].slot = k; st[top].depth = f->depth + 1;                  \
+            st[top].next = 0;                                                \
+            top++;                                                           \
+            st[top - 1].mask = PRE(ctx, c, f->node, k, f->depth + 1);        \
+            continue;                                                        \
+        }                                                                    \
+        POST(ctx, f->node, f->parent, f->slot);                              \
+        {                                                                    \
+            NodeT s = SIBLING(ctx, f->node);                                 \
+            if (s != NIL) {                                                  \
+                SIB(ctx, f->node, f->parent, f->slot);                       \
+                f->node = s;                                                 \
+                f->next = 0;                                                 \
+                f->mask = PRE(ctx, s, f->parent, f->slot, f->depth);         \
+            }                                                                \
+            else                                                             \
+                top--;                                                       \
+        }                                                                    \
+    }                                                                        \
+    if (st != local) free(st);                                               \
+}
+
+/* TreeNode 용 */
+#define TREE_CHILD(ctx, t, k)  ((t)->child[k])
+#define TREE_SIBLING(ctx, t)   ((t)->sibling)
+#define DEFINE_TREE_VISITOR(name, Ctx, PRE, MID, SIB, POST) \
+    DEFINE_VISITOR(name, TreeNode*, NULL, TREE_CHILD, TREE_SIBLING, Ctx, PRE, MID, SIB, POST)
+
+/* flat 트리(flat.h) 용: Ctx 에 const FlatTree* flat 멤버가 있어야 한다 */
+#define FLAT_CHILD(ctx, i, k)  flatChild((ctx)->flat, i, k)
+#define FLAT_SIBLING(ctx, i)   flatSibling((ctx)->flat, i)
+#define DEFINE_FLAT_VISITOR(name, Ctx, PRE, MID, SIB, POST) \
+    DEFINE_VISITOR(name, int, -1, FLAT_CHILD, FLAT_SIBLING, Ctx, PRE, MID, SIB, POST)
+
+#endif